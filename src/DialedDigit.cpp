@@ -1,23 +1,71 @@
 #include "DialedDigit.h"
 
-DialedDigit::DialedDigit(): value(-1)
+DialedDigit::DialedDigit(): head(0), count(0)
+#ifdef ENABLE_DIALED_DIGIT_HOOK
+    , pushHook(nullptr), pushHookContext(nullptr)
+#endif
 {}
 
 bool DialedDigit::isNew() const
 {
-    return this->value > -1;
+    return this->count > 0;
 }
 
-void DialedDigit::push(unsigned int value)
+/**
+ * @return bool Whether the next digit is part of a speed dial burst.
+ */
+bool DialedDigit::isBurst() const
 {
-    this->value = (int) value;
+    return this->isNew() && (this->digits[this->head] & DIALED_DIGIT_BURST_bm);
 }
 
+/**
+ * @return unsigned int How many digits can still be pushed.
+ */
+unsigned int DialedDigit::getFreeCount() const
+{
+    return DIALED_DIGITS_QUEUE_SIZE - this->count;
+}
+
+/**
+ * @return bool false when the queue is full, the digit being dropped.
+ */
+bool DialedDigit::push(unsigned int value, bool burst)
+{
+    if (DIALED_DIGITS_QUEUE_SIZE == this->count) {
+        return false;
+    }
+
+    this->digits[(this->head + this->count) % DIALED_DIGITS_QUEUE_SIZE] =
+        (value & DIALED_DIGIT_VALUE_gm) | (burst ? DIALED_DIGIT_BURST_bm : 0);
+    ++this->count;
+
+#ifdef ENABLE_DIALED_DIGIT_HOOK
+    if (nullptr != this->pushHook) {
+        this->pushHook(value & DIALED_DIGIT_VALUE_gm, burst, this->pushHookContext);
+    }
+#endif
+
+    return true;
+}
+
+/**
+ * @return unsigned int The next digit, which is removed from the queue.
+ */
 unsigned int DialedDigit::flush()
 {
-    unsigned int val = this->value;
+    unsigned int val = this->digits[this->head] & DIALED_DIGIT_VALUE_gm;
 
-    this->value = -1;
+    this->head = (this->head + 1) % DIALED_DIGITS_QUEUE_SIZE;
+    --this->count;
 
     return val;
 }
+
+#ifdef ENABLE_DIALED_DIGIT_HOOK
+void DialedDigit::onPush(DialedDigitHook hook, void* context)
+{
+    this->pushHook = hook;
+    this->pushHookContext = context;
+}
+#endif
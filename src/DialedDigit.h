@@ -1,17 +1,48 @@
 #ifndef S63_DIALEDDIGIT_H
 #define S63_DIALEDDIGIT_H
 
+// how many digits can wait for their tone, e.g. the ones of a speed dial
+#define DIALED_DIGITS_QUEUE_SIZE 32
+// set on the digits to play at the speed dial burst timings
+#define DIALED_DIGIT_BURST_bm 0x80
+#define DIALED_DIGIT_VALUE_gm 0x7F
+
+#ifdef ENABLE_DIALED_DIGIT_HOOK
+/**
+ * Called for each digit queued, for the host tools to follow what the firmware
+ * queues rather than guessing it from the dialing.
+ */
+typedef void (*DialedDigitHook)(unsigned int value, bool burst, void* context);
+#endif
+
+/**
+ * The queue of the digits waiting for their tone.
+ *
+ * It is filled and emptied from the ISRs only (which do not nest), so no
+ * access needs to be guarded.
+ */
 class DialedDigit
 {
     public:
         DialedDigit();
 
         bool isNew() const;
-        void push(unsigned int value);
+        bool isBurst() const;
+        unsigned int getFreeCount() const;
+        bool push(unsigned int value, bool burst = false);
         unsigned int flush();
+#ifdef ENABLE_DIALED_DIGIT_HOOK
+        void onPush(DialedDigitHook hook, void* context);
+#endif
 
     private:
-        int value;
+        unsigned char digits[DIALED_DIGITS_QUEUE_SIZE];
+        unsigned char head;
+        unsigned char count;
+#ifdef ENABLE_DIALED_DIGIT_HOOK
+        DialedDigitHook pushHook;
+        void* pushHookContext;
+#endif
 };
 
 #endif
@@ -1,74 +1,82 @@
 #include "Variables.h"
 #include "DtmfGenerator.h"
 #include "DialedDigit.h"
+#include "PwmTimer.h"
+#include "Log.h"
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
+#include "RotaryListener.h"
+#endif
 
-#include <math.h>
 #include <Arduino.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
-static DtmfGenerator* DtmfGenerator::instance = nullptr;
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>* BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::instance = nullptr;
 
 /**
  * Sinwave lookup table. Use a lookup table to get sinwave values
  * instead of computing it.
- * The table was generated with /tools/sinwave_lookup_table_generator.c .
+ * The table was generated with /tools/sinwave_lookup_table_generator.c
+ * (using a 65535 values range).
  *
- * The values will be used to produce the duty cycles of the output PWM.
+ * The values will be used to produce the duty cycles of the output PWM, once
+ * shifted down to its resolution.
  */
-static const unsigned int DtmfGenerator::sinwaveLut[PERIOD_SAMPLES_COUNT] = {
-    127, 130, 133, 136, 139, 143, 146, 149,
-    152, 155, 158, 161, 164, 167, 170, 173,
-    176, 178, 181, 184, 187, 190, 192, 195,
-    198, 200, 203, 205, 208, 210, 212, 215,
-    217, 219, 221, 223, 225, 227, 229, 231,
-    233, 234, 236, 238, 239, 240, 242, 243,
-    244, 245, 247, 248, 249, 249, 250, 251,
-    252, 252, 253, 253, 253, 254, 254, 254,
-    254, 254, 254, 254, 253, 253, 253, 252,
-    252, 251, 250, 249, 249, 248, 247, 245,
-    244, 243, 242, 240, 239, 238, 236, 234,
-    233, 231, 229, 227, 225, 223, 221, 219,
-    217, 215, 212, 210, 208, 205, 203, 200,
-    198, 195, 192, 190, 187, 184, 181, 178,
-    176, 173, 170, 167, 164, 161, 158, 155,
-    152, 149, 146, 143, 139, 136, 133, 130,
-    127, 124, 121, 118, 115, 111, 108, 105,
-    102,  99,  96,  93,  90,  87,  84,  81,
-     78,  76,  73,  70,  67,  64,  62,  59,
-     56,  54,  51,  49,  46,  44,  42,  39,
-     37,  35,  33,  31,  29,  27,  25,  23,
-     21,  20,  18,  16,  15,  14,  12,  11,
-     10,   9,   7,   6,   5,   5,   4,   3,
-      2,   2,   1,   1,   1,   0,   0,   0,
-      0,   0,   0,   0,   1,   1,   1,   2,
-      2,   3,   4,   5,   5,   6,   7,   9,
-     10,  11,  12,  14,  15,  16,  18,  20,
-     21,  23,  25,  27,  29,  31,  33,  35,
-     37,  39,  42,  44,  46,  49,  51,  54,
-     56,  59,  62,  64,  67,  70,  73,  76,
-     78,  81,  84,  87,  90,  93,  96,  99,
-    102, 105, 108, 111, 115, 118, 121, 124
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+const unsigned int BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::sinwaveLut[SINWAVE_SAMPLES_COUNT] = {
+    32767, 33571, 34375, 35177, 35979, 36778, 37575, 38369,
+    39160, 39946, 40729, 41506, 42279, 43045, 43806, 44560,
+    45306, 46046, 46777, 47499, 48213, 48918, 49613, 50297,
+    50971, 51635, 52286, 52926, 53554, 54170, 54772, 55361,
+    55937, 56498, 57046, 57578, 58096, 58599, 59086, 59557,
+    60012, 60450, 60872, 61277, 61665, 62035, 62388, 62723,
+    63040, 63338, 63619, 63880, 64123, 64347, 64552, 64738,
+    64904, 65052, 65179, 65288, 65376, 65445, 65495, 65524,
+    65534, 65524, 65495, 65445, 65376, 65288, 65179, 65052,
+    64904, 64738, 64552, 64347, 64123, 63880, 63619, 63338,
+    63040, 62723, 62388, 62035, 61665, 61277, 60872, 60450,
+    60012, 59557, 59086, 58599, 58096, 57578, 57046, 56498,
+    55937, 55361, 54772, 54170, 53554, 52926, 52286, 51635,
+    50971, 50297, 49613, 48918, 48213, 47499, 46777, 46046,
+    45306, 44560, 43806, 43045, 42279, 41506, 40729, 39946,
+    39160, 38369, 37575, 36778, 35979, 35177, 34375, 33571,
+    32767, 31963, 31159, 30357, 29555, 28756, 27959, 27165,
+    26374, 25588, 24805, 24028, 23255, 22489, 21728, 20974,
+    20228, 19488, 18757, 18035, 17321, 16616, 15921, 15237,
+    14563, 13899, 13248, 12608, 11980, 11364, 10762, 10173,
+     9597,  9036,  8488,  7956,  7438,  6935,  6448,  5977,
+     5522,  5084,  4662,  4257,  3869,  3499,  3146,  2811,
+     2494,  2196,  1915,  1654,  1411,  1187,   982,   796,
+      630,   482,   355,   246,   158,    89,    39,    10,
+        0,    10,    39,    89,   158,   246,   355,   482,
+      630,   796,   982,  1187,  1411,  1654,  1915,  2196,
+     2494,  2811,  3146,  3499,  3869,  4257,  4662,  5084,
+     5522,  5977,  6448,  6935,  7438,  7956,  8488,  9036,
+     9597, 10173, 10762, 11364, 11980, 12608, 13248, 13899,
+    14563, 15237, 15921, 16616, 17321, 18035, 18757, 19488,
+    20228, 20974, 21728, 22489, 23255, 24028, 24805, 25588,
+    26374, 27165, 27959, 28756, 29555, 30357, 31159, 31963
 };
 
-static unsigned int DtmfGenerator::computeToneStepSize(unsigned int tone)
-{
-    // Use a float to handle large numbers in the formula.
-    // Also, apply a scale to have a significant step size, in order to keep the
-    // precision in the formula (as the precision is in the decimals, before
-    // applying this scale).
-    // Other similar projects are using a `8` multiplier, whith an `(exceed 8)`
-    // hint about what this multiplier is supposed to do. I don't get why,
-    // (it's probably related to the amount of bits used in the counter, e.g.
-    // for the period samples count or the max value of the PWM duty cycle).
-    // Anyway, using this scale, I'm able to produce step sizes that are similar
-    // with what they are also producing.
-    //
-    // @see https://github.com/inaxeon/rotarydial/blob/6e3ef957c9aef3cefc727e853427a96fab0c2e6d/dtmf.c#L79
-    float scale = 16.0;
-
-    return (unsigned int) round((scale * PERIOD_SAMPLES_COUNT * tone) / PERIOD_FREQUENCY);
-}
+/**
+ * Raised cosine ramp lookup table, used as the gain of the attack of the tones,
+ * and read backward for their decay. Starting and ending the tones smoothly
+ * instead of with a step prevents clicks on the line.
+ * The table was generated with /tools/sinwave_lookup_table_generator.c
+ * --ramp --samples-count 64 .
+ */
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+const unsigned char BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::envelopeLut[ENVELOPE_LUT_SAMPLES_COUNT] = {
+      0,   1,   1,   2,   4,   5,   7,  10,
+     12,  15,  18,  21,  25,  29,  33,  37,
+     42,  47,  52,  57,  62,  67,  73,  79,
+     85,  90,  97, 103, 109, 115, 121, 127,
+    134, 140, 146, 152, 158, 165, 170, 176,
+    182, 188, 193, 198, 203, 208, 213, 218,
+    222, 226, 230, 234, 237, 240, 243, 245,
+    248, 250, 251, 253, 254, 254, 255, 255
+};
 
 /*
 @see https://en.wikipedia.org/wiki/Dual-tone_multi-frequency_signaling
@@ -90,7 +98,8 @@ The map represents the step size on the above sinwaveLut to make on each interru
 period.
 The step size depends on the tone and the interrupt frequency.
 */
-static const unsigned int DtmfGenerator::digitToTonesStepSize[12][2] = {
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+const unsigned int BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::digitToTonesStepSize[12][2] = {
     { computeToneStepSize(1336), computeToneStepSize(941) }, // 0
     { computeToneStepSize(1209), computeToneStepSize(697) }, // 1
     { computeToneStepSize(1336), computeToneStepSize(697) }, // 2
@@ -105,86 +114,148 @@ static const unsigned int DtmfGenerator::digitToTonesStepSize[12][2] = {
     { computeToneStepSize(1477), computeToneStepSize(941) }  // #
 };
 
-static DtmfGenerator* DtmfGenerator::build(
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>* BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::build(
     DialedDigit* dialedDigit,
     unsigned int dtmfDurationMs
 )
 {
     if (nullptr == instance) {
-        instance = new DtmfGenerator(dialedDigit, dtmfDurationMs);
+        instance = new BasicDtmfGenerator(dialedDigit, dtmfDurationMs);
     }
 
     return instance;
 }
 
-static DtmfGenerator* DtmfGenerator::getInstance()
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>* BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::getInstance()
 {
     return instance;
 }
 
-DtmfGenerator::DtmfGenerator(
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::BasicDtmfGenerator(
     DialedDigit* dialedDigit,
     unsigned int dtmfDurationMs
 ):  dialedDigit(dialedDigit),
     dtmfDurationMs(dtmfDurationMs),
     remainingGenerationCycles(-1),
+    generationCycles(0),
+    remainingPauseCycles(0),
     toneHighStepSize(0),
     toneLowStepSize(0),
     toneHighPos(0),
     toneLowPos(0)
+#ifdef ENABLE_ISR_PROFILING
+    , isrProfiler((PWM_MAX_VALUE + 1UL) * PwmTimer::CLOCK_DIVIDER)
+#endif
 {
+    static_assert(
+        ResolutionBits <= PwmTimer::MAX_RESOLUTION_BITS,
+        "The PWM resolution is not supported by the PWM timer."
+    );
+    static_assert(
+        ResolutionBits <= SINWAVE_RESOLUTION_BITS,
+        "The PWM resolution exceeds the sinwave lookup table one."
+    );
+    static_assert(
+        PERIOD_FREQUENCY > 4 * DTMF_HIGHEST_TONE,
+        "The sample rate is too low to produce the DTMF tones, lower the PWM resolution."
+    );
+    static_assert(
+        computeToneStepSize(DTMF_HIGHEST_TONE) < (1UL << 16) / 2,
+        "The step size of the highest tone should not exceed half a sinwave period."
+    );
+    static_assert(
+        DTMF_SAMPLES_COUNT <= 32767 && DTMF_BURST_SAMPLES_COUNT <= 32767,
+        "The tone samples count should fit in a 16bit int, lower the tone duration."
+    );
+    static_assert(
+        ENVELOPE_SAMPLES_COUNT >= 8,
+        "The envelope ramp is too short to prevent clicks, raise its duration or lower the PWM resolution."
+    );
+    // the rounding of the lookup table position must not go past its end
+    static_assert(
+        ENVELOPE_SAMPLES_COUNT <= 256,
+        "The envelope ramp is too long for its lookup table, lower its duration."
+    );
+    static_assert(
+        DTMF_SAMPLES_COUNT >= 2 * ENVELOPE_SAMPLES_COUNT
+            && DTMF_BURST_SAMPLES_COUNT >= 2 * ENVELOPE_SAMPLES_COUNT,
+        "The tone should be long enough to hold both its attack and its decay."
+    );
+    static_assert(
+        DTMF_PAUSE_SAMPLES_COUNT <= 32767,
+        "The pause samples count should fit in a 16bit int, lower the pause duration."
+    );
+
     instance = this;
 }
 
-void DtmfGenerator::setup()
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+void BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::setup()
 {
-    // Configure timer TCB1 of the chip for PWM.
-    // See Chapter 21 of ATmega4809 datasheet.
-
-    // enable PWM on output pin (pin D3 aka PF5, see datasheet p146).
-    PORTMUX.TCBROUTEA |= PORTMUX_TCB1_bm;
-    // schedule counter speed at µC speed / 1 (i.e. same as XTAL)
-    TCB1.CTRLA |= TCB_CLKSEL_CLKDIV1_gc;
-    // quiet the output (by setting the compare value to 0)
-    this->quiet();
-    // interrupts should be captured (i.e. enable callback)
-    TCB1.INTCTRL |= TCB_CAPT_bm;
-    // set timer mode to Pulse Width Modulation (8bits)
-    TCB1.CTRLB |= TCB_CNTMODE_PWM8_gc;
-    // enable waveform output on the corresponding pin
-    TCB1.CTRLB |= TCB_CCMPEN_bm;
-    // do not capture input events
-    TCB1.EVCTRL &= ~TCB_CAPTEI_bm;
-    // enable the counter
-    TCB1.CTRLA |= TCB_ENABLE_bm;
-
-    // Clear the interrupt flag which may have been set while configuring the
-    // timer (as the datasheet recommands).
-    TCB1.INTFLAGS |= TCB_CAPT_bm;
+    // Configure the timer for PWM, and quiet the output (by setting the
+    // compare value to the sinwave middle).
+    PwmTimer::setup(PWM_MAX_VALUE, PWM_MIDPOINT_VALUE);
 }
 
+#ifdef ENABLE_ISR_PROFILING
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+IsrProfiler* BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::getIsrProfiler()
+{
+    return &this->isrProfiler;
+}
+#endif
+
 // ISR triggered at PERIOD_FREQUENCY.
 // The ISR callback is a static method.
-ISR(TCB1_INT_vect)
+ISR(DTMF_PWM_TIMER_VECT)
 {
+#ifdef ENABLE_ISR_PROFILING
+    unsigned long startCycles = (unsigned long) DtmfGenerator::Timer::getCounter()
+        * DtmfGenerator::Timer::CLOCK_DIVIDER;
+#endif
+
     DtmfGenerator* dtmfGenerator = DtmfGenerator::getInstance();
 
     if (nullptr != dtmfGenerator) {
         dtmfGenerator->handleIsr();
     }
 
-    // Clear the interrupt flag (i.e. indicates that the interrupt has been
-    // handled. This is not done automatically).
-    TCB1.INTFLAGS |= TCB_CAPT_bm;
+    DtmfGenerator::Timer::clearInterruptFlag();
+
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
+    // Polled once the sample is produced and the flag cleared : should a poll
+    // last longer than a PWM period, the ISR is triggered again right away
+    // instead of skipping a sample.
+    RotaryListener* rotaryListener = RotaryListener::getInstance();
+
+    if (nullptr != rotaryListener) {
+        rotaryListener->handleTick();
+    }
+#endif
+
+#ifdef ENABLE_ISR_PROFILING
+    if (nullptr != dtmfGenerator) {
+        dtmfGenerator->getIsrProfiler()->record(
+            startCycles,
+            (unsigned long) DtmfGenerator::Timer::getCounter() * DtmfGenerator::Timer::CLOCK_DIVIDER
+        );
+    }
+#endif
 }
 
-void DtmfGenerator::handleIsr()
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+void BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::handleIsr()
 {
     if (0 == this->remainingGenerationCycles) {
-        Serial.println("quieting");
+        LOG("quieting");
         this->quiet();
 
         this->remainingGenerationCycles = -1;
+        // the queued tones (e.g. of a speed dial burst) must not be merged
+        this->remainingPauseCycles = DTMF_PAUSE_SAMPLES_COUNT;
 
         return;
     }
@@ -197,21 +268,34 @@ void DtmfGenerator::handleIsr()
         return;
     }
 
+    if (this->remainingPauseCycles > 0) {
+        --this->remainingPauseCycles;
+
+        return;
+    }
+
     if (this->dialedDigit->isNew()) {
         this->scheduleDtmfGeneration();
     }
 }
 
-void DtmfGenerator::quiet()
+/**
+ * Rest on the middle of the sinwave rather than on a 0 duty cycle, so that
+ * the tones start and end without any DC step.
+ */
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+void BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::quiet()
 {
-    this->setDutyCycle(0);
+    this->setDutyCycle(PWM_MIDPOINT_VALUE);
 }
 
-void DtmfGenerator::scheduleDtmfGeneration()
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+void BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::scheduleDtmfGeneration()
 {
+    const bool burst = this->dialedDigit->isBurst();
     unsigned int dialedDigit = this->dialedDigit->flush();
 
-    Serial.println((String) "Scheduling DTMF for digit " + dialedDigit);
+    LOG((String) "Scheduling DTMF for digit " + dialedDigit);
 
     this->toneHighStepSize = digitToTonesStepSize[dialedDigit][0];
     this->toneLowStepSize = digitToTonesStepSize[dialedDigit][1];
@@ -219,55 +303,90 @@ void DtmfGenerator::scheduleDtmfGeneration()
     this->toneHighPos = 0;
     this->toneLowPos = 0;
 
-    // Although I first though that the value of the remaining generation cycles
-    // would have been the result of the following formula :
-    // (int) ((DTMF_DURATION_MS * PERIOD_FREQUENCY) / 1000)
-    // it appears that it leads to veeery long DTMF durations (e.g. for an
-    // expected duration of 300ms, it leads to an actual 19200ms duration :o ).
-    // So, even if it appears to be counter intuitive to directly set the
-    // expected DTMF duration to this var, it actually produces the expected
-    // duration :p .
-    // This gap with the expected duration and the actual duration when using
-    // the formula may be because of how this program is designed. All the logic
-    // is done during the ISR (which acts like a clock tick), whereas other
-    // similar projects are only using the ISR to compute the new duty cycle of
-    // the PWM. I'd like to keep the logic as it is for now, as I'm not relying
-    // on any `delay` calls, opposed to other similar projects.
-    this->remainingGenerationCycles = DTMF_DURATION_MS;
+    // One cycle per ISR, i.e. per sample. The timer used to run on the TCA0
+    // clock left by the Arduino core (i.e. 64 times slower than expected),
+    // which made this count look like it had to be expressed in ms.
+    this->generationCycles = burst ? DTMF_BURST_SAMPLES_COUNT : DTMF_SAMPLES_COUNT;
+    this->remainingGenerationCycles = this->generationCycles;
 }
 
-void DtmfGenerator::generateDtmf()
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+void BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::generateDtmf()
 {
-    unsigned int toneHighWave = sinwaveLut[this->toneHighPos];
-    unsigned int toneLowWave = sinwaveLut[this->toneLowPos];
-
-    unsigned int sumWave = (unsigned int) round((toneHighWave + toneLowWave) / 2);
+    unsigned int toneHighWave = this->getSinwaveSample(this->toneHighPos);
+    unsigned int toneLowWave = this->getSinwaveSample(this->toneLowPos);
+
+    unsigned int sumWave = (toneHighWave + toneLowWave) / 2;
+    unsigned char gain = this->getEnvelopeGain();
+
+    if (gain < ENVELOPE_MAX_GAIN) {
+        // Scale the signal around the sinwave middle. The shift stands for the
+        // division by the gain range, so that no division is done here.
+        int signal = (int) sumWave - PWM_MIDPOINT_VALUE;
+
+        if (ResolutionBits > 8) {
+            // the product exceeds a 16bit int above a 8bit resolution
+            sumWave = PWM_MIDPOINT_VALUE + (int) (((long) signal * gain) >> 8);
+        } else {
+            sumWave = PWM_MIDPOINT_VALUE + ((signal * gain) >> 8);
+        }
+    }
 
     this->setDutyCycle(sumWave);
 
-    this->toneHighPos += this->toneHighStepSize;
+    // wrap around (for free on the µC, as an unsigned int is 16bit there)
+    this->toneHighPos = (this->toneHighPos + this->toneHighStepSize) & 0xFFFF;
+    this->toneLowPos = (this->toneLowPos + this->toneLowStepSize) & 0xFFFF;
+}
 
-    // wrap around
-    if (this->toneHighPos > PERIOD_SAMPLES_COUNT -1) {
-        this->toneHighPos -= PERIOD_SAMPLES_COUNT;
-    }
+/**
+ * @return unsigned int The sinwave value at the given 8.8 fixed point position,
+ * in the PWM resolution.
+ */
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+unsigned int BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::getSinwaveSample(unsigned int position) const
+{
+    return sinwaveLut[position >> SINWAVE_POSITION_FRACTION_BITS]
+        >> (SINWAVE_RESOLUTION_BITS - ResolutionBits)
+    ;
+}
 
-    this->toneLowPos += this->toneLowStepSize;
+/**
+ * @return unsigned char The gain to apply on the current sample : ramping up
+ * during the first ENVELOPE_SAMPLES_COUNT samples of the tone, and down during
+ * its last ones, so that its last sample is on the sinwave middle.
+ */
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+unsigned char BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::getEnvelopeGain() const
+{
+    unsigned int elapsedCycles = this->generationCycles - this->remainingGenerationCycles;
+
+    if (elapsedCycles < ENVELOPE_SAMPLES_COUNT) {
+        return envelopeLut[getEnvelopeLutIndex(elapsedCycles)];
+    }
 
-    // wrap around
-    if (this->toneLowPos > PERIOD_SAMPLES_COUNT -1) {
-        this->toneLowPos -= PERIOD_SAMPLES_COUNT;
+    if (this->remainingGenerationCycles <= (int) ENVELOPE_SAMPLES_COUNT) {
+        return envelopeLut[getEnvelopeLutIndex(this->remainingGenerationCycles - 1)];
     }
+
+    return ENVELOPE_MAX_GAIN;
 }
 
 /**
- * Set TCB1 counter compare value to have a `dutyCycle` duty cycle (CCMPH),
- * and to have the 8bit pulse period (CCMPL).
+ * @return unsigned int The entry of the envelope lookup table to read for the
+ * given sample of a ramp. The 16bit product holds as the ramp can't exceed 256
+ * samples.
  */
-void DtmfGenerator::setDutyCycle(unsigned int dutyCycle)
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+unsigned int BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::getEnvelopeLutIndex(unsigned int rampCycle)
 {
-    // These values has to be set separatly (i.e. not by using the CCMP 16 bit
-    // registry entry directly).
-    TCB1.CCMPL = TCB1_MAX_VALUE;
-    TCB1.CCMPH = dutyCycle;
+    return (rampCycle * ENVELOPE_LUT_STEP_SIZE + 0x80) >> 8;
 }
+
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+void BasicDtmfGenerator<ClockFrequency, ResolutionBits, PwmTimer>::setDutyCycle(unsigned int dutyCycle)
+{
+    PwmTimer::setDutyCycle(PWM_MAX_VALUE, dutyCycle);
+}
+
+template class BasicDtmfGenerator<XTAL, DTMF_PWM_RESOLUTION_BITS, DTMF_PWM_TIMER>;
@@ -3,48 +3,140 @@
 
 #include "Variables.h"
 #include "DialedDigit.h"
+#include "PwmTimer.h"
+#ifdef ENABLE_ISR_PROFILING
+#include "IsrProfiler.h"
+#endif
 
-// 0xFF, TCB1 in PWM mode is a 8bit counter, starts to count from 0
-#define TCB1_MAX_VALUE 255
-// how many samples per period (i.e. clock cycles per interrupt)
-#define PERIOD_SAMPLES_COUNT ( TCB1_MAX_VALUE + 1 )
-#define PERIOD_FREQUENCY ( XTAL / PERIOD_SAMPLES_COUNT )
+// how many samples the sinwave lookup table holds for a period
+#define SINWAVE_SAMPLES_COUNT 256
+// the values of the sinwave lookup table are 16bit, they are shifted down to
+// the PWM resolution
+#define SINWAVE_RESOLUTION_BITS 16
+// The position in the sinwave lookup table is a 8.8 fixed point number, the
+// 8 lowest bits being the fractional part. This keeps the precision of the
+// tones frequencies, while wrapping around the table for free on 16bit.
+#define SINWAVE_POSITION_FRACTION_BITS 8
+// how long the attack and the decay of a tone last, in µs
+#define ENVELOPE_DURATION_US 1000
+// how many samples the envelope lookup table holds for a ramp, which is
+// stretched over the samples of the attack and of the decay
+#define ENVELOPE_LUT_SAMPLES_COUNT 64
+// the gain of the tone once the attack is over, 0xFF
+#define ENVELOPE_MAX_GAIN 255
+// the highest DTMF tone frequency, in Hz
+#define DTMF_HIGHEST_TONE 1633
 
-class DtmfGenerator
+/**
+ * Generates the DTMF tone of the dialed digits on a PWM output.
+ *
+ * The generator is parameterized at compile time, so that all its timings are
+ * derived from the µC frequency (ClockFrequency, in Hz), the resolution of the
+ * PWM (ResolutionBits) and the timer generating it (PwmTimer, see
+ * PwmTimer.h). An ISR is triggered on each PWM period, which produces the next
+ * sample.
+ */
+template<unsigned long ClockFrequency, unsigned char ResolutionBits, class PwmTimer>
+class BasicDtmfGenerator
 {
     public:
-        static DtmfGenerator* build(
+        typedef PwmTimer Timer;
+
+        // the PWM counter counts from 0 up to this value
+        static constexpr unsigned int PWM_MAX_VALUE = (1UL << ResolutionBits) - 1;
+        // the duty cycle of the middle of the sinwave (i.e. the zero of the
+        // produced signal), which is also the output level while no tone is
+        // generated
+        static constexpr unsigned int PWM_MIDPOINT_VALUE = PWM_MAX_VALUE / 2;
+        // how many samples per second (i.e. one per PWM period)
+        static constexpr unsigned long PERIOD_FREQUENCY =
+            ClockFrequency / PwmTimer::CLOCK_DIVIDER / (PWM_MAX_VALUE + 1UL);
+        // how many samples the tone lasts
+        static constexpr unsigned long DTMF_SAMPLES_COUNT =
+            (unsigned long long) DTMF_DURATION_MS * PERIOD_FREQUENCY / 1000;
+        // how many samples a tone of a speed dial burst lasts
+        static constexpr unsigned long DTMF_BURST_SAMPLES_COUNT =
+            (unsigned long long) DTMF_BURST_DURATION_MS * PERIOD_FREQUENCY / 1000;
+        // how many samples the output stays quiet between two tones
+        static constexpr unsigned long DTMF_PAUSE_SAMPLES_COUNT =
+            (unsigned long long) DTMF_PAUSE_MS * PERIOD_FREQUENCY / 1000;
+        // how many samples the attack and the decay of a tone last
+        static constexpr unsigned long ENVELOPE_SAMPLES_COUNT =
+            (unsigned long long) ENVELOPE_DURATION_US * PERIOD_FREQUENCY / 1000000;
+        // How much the position in the envelope lookup table moves forward on
+        // each sample of a ramp, as a 8.8 fixed point number, so that the last
+        // sample of the ramp reads the last entry.
+        static constexpr unsigned int ENVELOPE_LUT_STEP_SIZE = (unsigned int) (
+            (ENVELOPE_LUT_SAMPLES_COUNT - 1.0) * 256 / (ENVELOPE_SAMPLES_COUNT - 1) + 0.5
+        );
+
+        static BasicDtmfGenerator* build(
             DialedDigit* dialedDigit,
             unsigned int dtmfDurationMs
         );
-        static DtmfGenerator* getInstance();
+        static BasicDtmfGenerator* getInstance();
         void setup();
         void handleIsr();
+#ifdef ENABLE_ISR_PROFILING
+        IsrProfiler* getIsrProfiler();
+#endif
 
     private:
-        DtmfGenerator(){};
-        DtmfGenerator(
+        BasicDtmfGenerator(){};
+        BasicDtmfGenerator(
             DialedDigit* dialedDigit,
             unsigned int dtmfDurationMs
         );
 
-        static DtmfGenerator* instance;
-        static const unsigned int sinwaveLut[PERIOD_SAMPLES_COUNT];
+        static BasicDtmfGenerator* instance;
+        static const unsigned int sinwaveLut[SINWAVE_SAMPLES_COUNT];
         static const unsigned int digitToTonesStepSize[12][2];
-        static unsigned int computeToneStepSize(unsigned int tone);
+        static const unsigned char envelopeLut[ENVELOPE_LUT_SAMPLES_COUNT];
+
+        /**
+         * @return unsigned int How much the position in the sinwave lookup
+         * table should move forward on each sample to produce the given tone
+         * frequency (in Hz).
+         */
+        static constexpr unsigned int computeToneStepSize(unsigned int tone)
+        {
+            return (unsigned int) (
+                (1.0 * SINWAVE_SAMPLES_COUNT * (1UL << SINWAVE_POSITION_FRACTION_BITS) * tone)
+                    / PERIOD_FREQUENCY
+                + 0.5
+            );
+        }
 
         DialedDigit* dialedDigit;
         unsigned int dtmfDurationMs;
         int remainingGenerationCycles;
+        unsigned int generationCycles;
+        int remainingPauseCycles;
         unsigned int toneHighStepSize;
         unsigned int toneLowStepSize;
         unsigned int toneHighPos;
         unsigned int toneLowPos;
+#ifdef ENABLE_ISR_PROFILING
+        IsrProfiler isrProfiler;
+#endif
 
         void quiet();
         void scheduleDtmfGeneration();
         void generateDtmf();
-        void setDutyCycle(unsigned int pulsesCount);
+        unsigned int getSinwaveSample(unsigned int position) const;
+        unsigned char getEnvelopeGain() const;
+        static unsigned int getEnvelopeLutIndex(unsigned int rampCycle);
+        void setDutyCycle(unsigned int dutyCycle);
 };
 
+#ifdef DTMF_PWM_TIMER_TCA0
+#define DTMF_PWM_TIMER Tca0PwmTimer
+#define DTMF_PWM_TIMER_VECT TCA0_OVF_vect
+#else
+#define DTMF_PWM_TIMER Tcb1PwmTimer
+#define DTMF_PWM_TIMER_VECT TCB1_INT_vect
+#endif
+
+typedef BasicDtmfGenerator<XTAL, DTMF_PWM_RESOLUTION_BITS, DTMF_PWM_TIMER> DtmfGenerator;
+
 #endif
@@ -0,0 +1,78 @@
+#include "IsrProfiler.h"
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+
+IsrProfiler::IsrProfiler(unsigned long periodCycles)
+:   periodCycles(periodCycles),
+    callsCount(0),
+    totalDurationCycles(0),
+    maxDurationCycles(0),
+    maxLatencyCycles(0),
+    overrunsCount(0)
+{}
+
+/**
+ * Called from the ISR, with the counter values (converted to µC cycles) when
+ * entering and leaving it.
+ */
+void IsrProfiler::record(unsigned long startCycles, unsigned long endCycles)
+{
+    // the counter has restarted from 0 while the ISR was running
+    if (endCycles < startCycles) {
+        ++this->overrunsCount;
+        endCycles += this->periodCycles;
+    }
+
+    unsigned long durationCycles = endCycles - startCycles;
+
+    ++this->callsCount;
+    this->totalDurationCycles += durationCycles;
+
+    if (durationCycles > this->maxDurationCycles) {
+        this->maxDurationCycles = durationCycles;
+    }
+
+    if (startCycles > this->maxLatencyCycles) {
+        this->maxLatencyCycles = startCycles;
+    }
+}
+
+/**
+ * Print the profile since the last report, and restart it. Meant to be called
+ * from the main loop.
+ */
+void IsrProfiler::report(const char* name)
+{
+    // the ISR must not record while the profile is read and restarted
+    cli();
+
+    unsigned long callsCount = this->callsCount;
+    unsigned long totalDurationCycles = this->totalDurationCycles;
+    unsigned long maxDurationCycles = this->maxDurationCycles;
+    unsigned long maxLatencyCycles = this->maxLatencyCycles;
+    unsigned long overrunsCount = this->overrunsCount;
+
+    this->callsCount = 0;
+    this->totalDurationCycles = 0;
+    this->maxDurationCycles = 0;
+    this->maxLatencyCycles = 0;
+    this->overrunsCount = 0;
+
+    sei();
+
+    if (0 == callsCount) {
+        Serial.println((String) name + " ISR : not triggered");
+
+        return;
+    }
+
+    Serial.println((String) name
+        + " ISR : " + callsCount + " calls"
+        + ", duration avg " + (totalDurationCycles / callsCount)
+        + " max " + maxDurationCycles
+        + ", latency max " + maxLatencyCycles
+        + " (cycles, period " + this->periodCycles + ")"
+        + ", overruns " + overrunsCount
+    );
+}
@@ -0,0 +1,38 @@
+#ifndef S63_ISRPROFILER_H
+#define S63_ISRPROFILER_H
+
+// how often the ISRs profiles are printed, in ms
+#define ISR_PROFILING_REPORT_DELAY_MS 5000
+
+// the logs would be part of the profiles, see LOG
+#if defined(ENABLE_ISR_PROFILING) && defined(ENABLE_LOGGING)
+#error "The ISRs can't be profiled with the logging enabled."
+#endif
+
+/**
+ * Measures the cost of an ISR in µC cycles, from the counter of the timer
+ * triggering it : the counter value when entering the ISR is its latency
+ * (e.g. while another ISR was running), and the difference with its value
+ * when leaving it is its duration.
+ *
+ * A duration exceeding the timer period can't be measured, it's reported as
+ * an overrun instead.
+ */
+class IsrProfiler
+{
+    public:
+        IsrProfiler(unsigned long periodCycles = 0);
+
+        void record(unsigned long startCycles, unsigned long endCycles);
+        void report(const char* name);
+
+    private:
+        unsigned long periodCycles;
+        unsigned long callsCount;
+        unsigned long totalDurationCycles;
+        unsigned long maxDurationCycles;
+        unsigned long maxLatencyCycles;
+        unsigned long overrunsCount;
+};
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef S63_LOG_H
+#define S63_LOG_H
+
+#include <Arduino.h>
+
+// Most logs are printed from the ISRs, where a full serial TX buffer makes the
+// print wait for the UART to send it. They are only built with ENABLE_LOGGING,
+// so that the pins capture and ISRs profiling builds keep their timings.
+#ifdef ENABLE_LOGGING
+#define LOG(message) Serial.println(message)
+#else
+#define LOG(message)
+#endif
+
+#endif
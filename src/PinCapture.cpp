@@ -0,0 +1,161 @@
+#include "PinCapture.h"
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+
+PinCapture::PinCapture(unsigned int pollPeriodUs)
+:   pollPeriodUs(pollPeriodUs),
+    oldestEntryIndex(0),
+    entriesCount(0),
+    pollsCount(0),
+    oldestEntryPoll(0),
+    frozen(false),
+    freezeReason(0)
+{}
+
+/**
+ * Called on each poll, with the pins levels which have just been read.
+ */
+void PinCapture::record(unsigned char rotaryMovePinStatus, unsigned char pulsePinStatus)
+{
+    // keep counting while frozen, so that the next capture is still dated
+    // from the boot
+    ++this->pollsCount;
+
+    if (this->frozen) {
+        return;
+    }
+
+    unsigned int levels = (HIGH == rotaryMovePinStatus ? PIN_CAPTURE_ROTARY_MOVE_bm : 0)
+        | (HIGH == pulsePinStatus ? PIN_CAPTURE_PULSE_bm : 0)
+    ;
+
+    if (this->entriesCount > 0) {
+        unsigned int* lastEntry = &this->entries[
+            (this->oldestEntryIndex + this->entriesCount - 1) % PIN_CAPTURE_ENTRIES_COUNT
+        ];
+
+        // the levels did not change, extend the current run (unless it's
+        // already as long as an entry can hold)
+        if (levels == (*lastEntry & ~PIN_CAPTURE_RUN_LENGTH_gm)
+            && PIN_CAPTURE_RUN_LENGTH_gm != (*lastEntry & PIN_CAPTURE_RUN_LENGTH_gm)
+        ) {
+            ++*lastEntry;
+
+            return;
+        }
+    }
+
+    this->pushEntry(levels | 1);
+}
+
+void PinCapture::pushEntry(unsigned int entry)
+{
+    if (PIN_CAPTURE_ENTRIES_COUNT == this->entriesCount) {
+        // drop the oldest entry
+        this->oldestEntryPoll += this->entries[this->oldestEntryIndex] & PIN_CAPTURE_RUN_LENGTH_gm;
+        this->oldestEntryIndex = (this->oldestEntryIndex + 1) % PIN_CAPTURE_ENTRIES_COUNT;
+        --this->entriesCount;
+    }
+
+    this->entries[(this->oldestEntryIndex + this->entriesCount) % PIN_CAPTURE_ENTRIES_COUNT] = entry;
+    ++this->entriesCount;
+}
+
+/**
+ * Stop recording, in order to keep the pins history which has led to an
+ * anomaly. Only the first anomaly is kept until the capture is exported.
+ */
+void PinCapture::freeze(unsigned char reason)
+{
+    if (this->frozen) {
+        return;
+    }
+
+    this->freezeReason = reason;
+    this->frozen = true;
+}
+
+bool PinCapture::isFrozen() const
+{
+    return this->frozen;
+}
+
+unsigned char PinCapture::getFreezeReason() const
+{
+    return this->freezeReason;
+}
+
+unsigned long PinCapture::getPollsCount() const
+{
+    return this->pollsCount;
+}
+
+/**
+ * Send the capture over serial when it's frozen. Sending takes far longer than
+ * a polling period, so this is meant to be called from the main loop and not
+ * from the polling ISR (which does not touch the entries while frozen).
+ */
+void PinCapture::exportIfFrozen()
+{
+    if (!this->frozen) {
+        return;
+    }
+
+    unsigned int checksum = 0;
+
+    Serial.write(PIN_CAPTURE_MAGIC);
+    checksum += this->writeByte(PIN_CAPTURE_FORMAT_VERSION);
+    checksum += this->writeByte(this->freezeReason);
+    checksum += this->writeWord(this->pollPeriodUs);
+    checksum += this->writeLong(this->oldestEntryPoll);
+    checksum += this->writeWord(this->entriesCount);
+
+    for (unsigned int i = 0; i < this->entriesCount; i++) {
+        checksum += this->writeWord(
+            this->entries[(this->oldestEntryIndex + i) % PIN_CAPTURE_ENTRIES_COUNT]
+        );
+    }
+
+    this->writeWord(checksum);
+
+    this->reset();
+}
+
+void PinCapture::reset()
+{
+    // the polling ISR must not record while the capture is restarted
+    cli();
+
+    this->oldestEntryIndex = 0;
+    this->entriesCount = 0;
+    this->oldestEntryPoll = this->pollsCount;
+    this->freezeReason = 0;
+    this->frozen = false;
+
+    sei();
+}
+
+/**
+ * @return unsigned int The sum of the written bytes.
+ */
+unsigned int PinCapture::writeByte(unsigned char value)
+{
+    Serial.write(value);
+
+    return value;
+}
+
+unsigned int PinCapture::writeWord(unsigned int value)
+{
+    return this->writeByte(value & 0xFF)
+        + this->writeByte((value >> 8) & 0xFF)
+    ;
+}
+
+unsigned int PinCapture::writeLong(unsigned long value)
+{
+    return this->writeWord(value & 0xFFFF)
+        + this->writeWord((value >> 16) & 0xFFFF)
+    ;
+}
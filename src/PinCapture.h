@@ -0,0 +1,68 @@
+#ifndef S63_PINCAPTURE_H
+#define S63_PINCAPTURE_H
+
+// How many run length encoded entries the capture keeps (2 bytes each). The
+// oldest entries are overwritten once the capture is full.
+#define PIN_CAPTURE_ENTRIES_COUNT 128
+
+// An entry is a 16bit word : the pins levels on the 2 highest bits, and for how
+// many consecutive polls these levels have been read on the 14 other ones.
+#define PIN_CAPTURE_ROTARY_MOVE_bm 0x8000
+#define PIN_CAPTURE_PULSE_bm 0x4000
+#define PIN_CAPTURE_RUN_LENGTH_gm 0x3FFF
+
+#define PIN_CAPTURE_MAGIC "S63C"
+#define PIN_CAPTURE_FORMAT_VERSION 2
+
+// why the capture has been frozen
+#define PIN_CAPTURE_PULSES_OVERFLOW 1
+#define PIN_CAPTURE_ZERO_PULSE_RELEASE 2
+
+/**
+ * Keeps the history of the rotary pins levels, as read on each poll, in order
+ * to be able to replay a dialing which has been wrongly decoded.
+ *
+ * The capture is frozen when an anomaly is detected, and is then exported
+ * over serial with the following little endian binary frame :
+ *
+ * - "S63C" magic (4 bytes)
+ * - format version (1 byte)
+ * - freeze reason (1 byte)
+ * - polling period, in µs (2 bytes)
+ * - index of the poll of the first entry, counting from the boot (4 bytes)
+ * - entries count (2 bytes)
+ * - entries, from the oldest one (2 bytes each)
+ * - sum of all the previous bytes but the magic (2 bytes)
+ *
+ * Once exported, the capture restarts from scratch.
+ */
+class PinCapture
+{
+    public:
+        PinCapture(unsigned int pollPeriodUs = 0);
+
+        void record(unsigned char rotaryMovePinStatus, unsigned char pulsePinStatus);
+        void freeze(unsigned char reason);
+        bool isFrozen() const;
+        unsigned char getFreezeReason() const;
+        unsigned long getPollsCount() const;
+        void exportIfFrozen();
+
+    private:
+        unsigned int pollPeriodUs;
+        unsigned int entries[PIN_CAPTURE_ENTRIES_COUNT];
+        unsigned int oldestEntryIndex;
+        unsigned int entriesCount;
+        unsigned long pollsCount;
+        unsigned long oldestEntryPoll;
+        volatile bool frozen;
+        unsigned char freezeReason;
+
+        void pushEntry(unsigned int entry);
+        void reset();
+        unsigned int writeByte(unsigned char value);
+        unsigned int writeWord(unsigned int value);
+        unsigned int writeLong(unsigned long value);
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "PwmTimer.h"
+
+#include <avr/io.h>
+
+void Tcb1PwmTimer::setup(unsigned int maxValue, unsigned int dutyCycle)
+{
+    // enable PWM on output pin (pin D3 aka PF5, see datasheet p146).
+    PORTMUX.TCBROUTEA |= PORTMUX_TCB1_bm;
+    // schedule counter speed at µC speed / 1 (i.e. same as XTAL). The clock
+    // source has to be replaced, as the Arduino core makes the TCB timers
+    // count on the TCA0 clock.
+    TCB1.CTRLA = (TCB1.CTRLA & ~TCB_CLKSEL_gm) | TCB_CLKSEL_CLKDIV1_gc;
+    // set the initial duty cycle
+    setDutyCycle(maxValue, dutyCycle);
+    // interrupts should be captured (i.e. enable callback)
+    TCB1.INTCTRL |= TCB_CAPT_bm;
+    // set timer mode to Pulse Width Modulation (8bits)
+    TCB1.CTRLB = (TCB1.CTRLB & ~TCB_CNTMODE_gm) | TCB_CNTMODE_PWM8_gc;
+    // enable waveform output on the corresponding pin
+    TCB1.CTRLB |= TCB_CCMPEN_bm;
+    // do not capture input events
+    TCB1.EVCTRL &= ~TCB_CAPTEI_bm;
+    // enable the counter
+    TCB1.CTRLA |= TCB_ENABLE_bm;
+
+    // Clear the interrupt flag which may have been set while configuring the
+    // timer (as the datasheet recommands).
+    clearInterruptFlag();
+}
+
+/**
+ * Set TCB1 counter compare value to have a `dutyCycle` duty cycle (CCMPH),
+ * and to have the 8bit pulse period (CCMPL).
+ */
+void Tcb1PwmTimer::setDutyCycle(unsigned int maxValue, unsigned int dutyCycle)
+{
+    // These values has to be set separatly (i.e. not by using the CCMP 16 bit
+    // registry entry directly).
+    TCB1.CCMPL = maxValue;
+    TCB1.CCMPH = dutyCycle;
+}
+
+void Tcb1PwmTimer::clearInterruptFlag()
+{
+    // Indicates that the interrupt has been handled. This is not done
+    // automatically.
+    TCB1.INTFLAGS |= TCB_CAPT_bm;
+}
+
+/**
+ * @return unsigned int How many µC cycles have elapsed since the beginning of
+ * the current PWM period (i.e. since the ISR has been triggered).
+ */
+unsigned int Tcb1PwmTimer::getCounter()
+{
+    // in 8bit PWM mode, only the low byte of the counter is used
+    return TCB1.CNTL;
+}
+
+void Tca0PwmTimer::setup(unsigned int maxValue, unsigned int dutyCycle)
+{
+    // The Arduino core runs TCA0 in split mode, which can only be left while
+    // the counter is stopped and after a hard reset (see datasheet p194).
+    TCA0.SINGLE.CTRLA &= ~TCA_SINGLE_ENABLE_bm;
+    TCA0.SINGLE.CTRLESET = TCA_SINGLE_CMD_RESET_gc;
+    TCA0.SINGLE.CTRLD &= ~TCA_SINGLE_SPLITM_bm;
+
+    // route the waveform outputs to PORTB, and enable the output pin (pin D9
+    // aka PB0)
+    PORTMUX.TCAROUTEA = PORTMUX_TCA0_PORTB_gc;
+    PORTB.DIRSET = PIN0_bm;
+    // schedule counter speed at µC speed / 1 (i.e. same as XTAL)
+    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV1_gc;
+    // set timer mode to single slope PWM, with the waveform output of the
+    // compare channel 0 enabled
+    TCA0.SINGLE.CTRLB = TCA_SINGLE_WGMODE_SINGLESLOPE_gc | TCA_SINGLE_CMP0EN_bm;
+    // the counter counts from 0 to maxValue
+    TCA0.SINGLE.PER = maxValue;
+    TCA0.SINGLE.CMP0 = dutyCycle;
+    setDutyCycle(maxValue, dutyCycle);
+    // interrupts should be triggered on each overflow (i.e. enable callback)
+    TCA0.SINGLE.INTCTRL = TCA_SINGLE_OVF_bm;
+    // enable the counter
+    TCA0.SINGLE.CTRLA |= TCA_SINGLE_ENABLE_bm;
+
+    // Clear the interrupt flag which may have been set while configuring the
+    // timer (as the datasheet recommands).
+    clearInterruptFlag();
+}
+
+/**
+ * Set the TCA0 buffered compare value, which is applied on the next overflow
+ * (i.e. without any glitch on the current period).
+ */
+void Tca0PwmTimer::setDutyCycle(unsigned int /* maxValue */, unsigned int dutyCycle)
+{
+    TCA0.SINGLE.CMP0BUF = dutyCycle;
+}
+
+void Tca0PwmTimer::clearInterruptFlag()
+{
+    // Indicates that the interrupt has been handled. This is not done
+    // automatically.
+    TCA0.SINGLE.INTFLAGS = TCA_SINGLE_OVF_bm;
+}
+
+/**
+ * @return unsigned int How many µC cycles have elapsed since the beginning of
+ * the current PWM period (i.e. since the ISR has been triggered).
+ */
+unsigned int Tca0PwmTimer::getCounter()
+{
+    return TCA0.SINGLE.CNT;
+}
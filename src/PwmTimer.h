@@ -0,0 +1,59 @@
+#ifndef S63_PWMTIMER_H
+#define S63_PWMTIMER_H
+
+#include "Variables.h"
+
+// The Arduino core makes TCA0 count at µC speed / 64. The TCB timers counting
+// on the TCA0 clock (e.g. the millis() one) depend on it, so it's changed only
+// when TCA0 generates the DTMF output PWM (at µC speed).
+#ifdef DTMF_PWM_TIMER_TCA0
+#define TCA0_CLOCK_DIVIDER 1
+#else
+#define TCA0_CLOCK_DIVIDER 64
+#endif
+// How many times faster than expected millis() counts, as the Arduino core
+// assumes the TCA0 clock is left at µC speed / 64.
+#define MILLIS_SPEEDUP (64UL / TCA0_CLOCK_DIVIDER)
+
+/**
+ * The timers able to generate the DTMF output PWM, and to trigger an ISR on
+ * each PWM period. Both count at µC speed, from 0 to `maxValue` (i.e. the PWM
+ * resolution).
+ */
+
+/**
+ * TCB1 in 8bit PWM mode, output on pin D3 (PF5).
+ * See Chapter 21 of ATmega4809 datasheet.
+ */
+class Tcb1PwmTimer
+{
+    public:
+        static constexpr unsigned char MAX_RESOLUTION_BITS = 8;
+        static constexpr unsigned int CLOCK_DIVIDER = 1;
+
+        static void setup(unsigned int maxValue, unsigned int dutyCycle);
+        static void setDutyCycle(unsigned int maxValue, unsigned int dutyCycle);
+        static void clearInterruptFlag();
+        static unsigned int getCounter();
+};
+
+/**
+ * TCA0 in 16bit single slope PWM mode, output on pin D9 (PB0).
+ * See Chapter 20 of ATmega4809 datasheet.
+ *
+ * The resolution is limited to 15bits, as two samples are summed on an
+ * unsigned int when generating the DTMF.
+ */
+class Tca0PwmTimer
+{
+    public:
+        static constexpr unsigned char MAX_RESOLUTION_BITS = 15;
+        static constexpr unsigned int CLOCK_DIVIDER = TCA0_CLOCK_DIVIDER;
+
+        static void setup(unsigned int maxValue, unsigned int dutyCycle);
+        static void setDutyCycle(unsigned int maxValue, unsigned int dutyCycle);
+        static void clearInterruptFlag();
+        static unsigned int getCounter();
+};
+
+#endif
@@ -1,16 +1,17 @@
 #include "Variables.h"
 #include "RotaryListener.h"
 #include "DialedDigit.h"
+#include "Log.h"
 
 #include <Arduino.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
-static const unsigned int RotaryListener::rotaryDigits[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0 };
+const unsigned int RotaryListener::rotaryDigits[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0 };
 
-static RotaryListener* RotaryListener::instance = nullptr;
+RotaryListener* RotaryListener::instance = nullptr;
 
-static RotaryListener* RotaryListener::build(
+RotaryListener* RotaryListener::build(
     DialedDigit* dialedDigit,
     unsigned int pinPollDelayMs
 )
@@ -22,7 +23,7 @@ static RotaryListener* RotaryListener::build(
     return instance;
 }
 
-static RotaryListener* RotaryListener::getInstance()
+RotaryListener* RotaryListener::getInstance()
 {
     return instance;
 }
@@ -33,32 +34,96 @@ RotaryListener::RotaryListener(
 ):  dialedDigit(dialedDigit),
     pinPollDelayMs(pinPollDelayMs),
     pulsesCount(0),
+    windUpPollsCount(0),
+    previousRotaryMovePinStatus(HIGH),
     rotaryMovePinStatus(HIGH),
     previousPulsePinStatus(LOW),
-    pulsePinStatus(LOW)
+    pulsePinStatus(LOW),
+    speedDial(dialedDigit),
+    pollTicksCount(getPollTicksCount(pinPollDelayMs)),
+    remainingPollTicks(getPollTicksCount(pinPollDelayMs))
+#ifdef ENABLE_PIN_CAPTURE
+    , pinCapture(getPollPeriodUs(pinPollDelayMs))
+#endif
+#ifdef ENABLE_ISR_PROFILING
+    , isrProfiler(getPollTimerPeriodCycles(pinPollDelayMs))
+#endif
 {
 }
 
+SpeedDial* RotaryListener::getSpeedDial()
+{
+    return &this->speedDial;
+}
+
+#ifdef ENABLE_PIN_CAPTURE
+PinCapture* RotaryListener::getPinCapture()
+{
+    return &this->pinCapture;
+}
+#endif
+
+#ifdef ENABLE_ISR_PROFILING
+IsrProfiler* RotaryListener::getIsrProfiler()
+{
+    return &this->isrProfiler;
+}
+#endif
+
 void RotaryListener::setup()
 {
     // enable input pins
     pinMode(ROTARY_MOVE_PIN, INPUT_PULLUP);
     pinMode(PULSE_PIN, INPUT_PULLUP);
 
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
+    // The pins are polled on the ticks of the DTMF PWM timer, see handleTick.
+    // TCB2 is left untouched.
+
+    static_assert(
+        getPollTicksCount(PIN_POLL_DELAY_MS) > 0
+            && getPollTicksCount(PIN_POLL_DELAY_MS) <= 0xFFFF,
+        "The poll delay can't be counted in DTMF PWM periods on 16bit."
+    );
+    // the poll delay is rounded to a whole count of DTMF PWM periods
+    static_assert(
+        getPollPeriodUs(PIN_POLL_DELAY_MS) >= PIN_POLL_DELAY_MS * 990.0
+            && getPollPeriodUs(PIN_POLL_DELAY_MS) <= PIN_POLL_DELAY_MS * 1010.0,
+        "The poll delay is not a multiple of the DTMF PWM period within 1%, raise it."
+    );
+#else
     // Configure timer TCB2 of the chip to trigger an ISR every
-    // PIN_POLL_DELAY_MS ms.
+    // PIN_POLL_DELAY_MS ms / getPollTicksCount, the pins being polled on the
+    // last one.
     // See Chapter 21 of ATmega4809 datasheet.
 
-    // schedule counter speed at µC speed / 1 (i.e. same as XTAL)
-    TCB2.CTRLA |= TCB_CLKSEL_CLKDIV1_gc;
+    static_assert(
+        getPollTicksCount(PIN_POLL_DELAY_MS) > 0
+            && getPollTicksCount(PIN_POLL_DELAY_MS) <= 0xFFFF,
+        "The poll delay can't be counted in TCB2 periods on 16bit."
+    );
+    static_assert(
+        getTcb2CompareValue(PIN_POLL_DELAY_MS) <= TCB2_MAX_VALUE,
+        "The poll delay does not fit in the TCB2 counter."
+    );
+    // the poll delay is rounded down to a whole count of TCB2 periods
+    static_assert(
+        getPollPeriodUs(PIN_POLL_DELAY_MS) >= PIN_POLL_DELAY_MS * 990.0,
+        "The poll delay is not a multiple of the TCB2 period within 1%, raise it."
+    );
+
+    // Count at µC speed rather than on the TCA0 clock (as the Arduino core
+    // sets it up), whose speed depends on the DTMF PWM timer. Which also makes
+    // the counter cycle accurate for the ISRs profiling.
+    TCB2.CTRLA = (TCB2.CTRLA & ~TCB_CLKSEL_gm) | TCB_CLKSEL_CLKDIV1_gc;
     // set counter compare value to have interrupts captured each
-    // PIN_POLL_DELAY_MS ms
-    TCB2.CCMP = this->getTcb2CompareValue();
+    // PIN_POLL_DELAY_MS ms / getPollTicksCount
+    TCB2.CCMP = getTcb2CompareValue(this->pinPollDelayMs);
     // interrupts should be captured (i.e. enable callback)
     TCB2.INTCTRL |= TCB_CAPT_bm;
     // set timer mode to interrupt (i.e. fire and event each time it has reached
-    // its CCMP value)
-    TCB2.CTRLB |= TCB_CNTMODE_INT_gc;
+    // its CCMP value). The Arduino core leaves it in 8bit PWM mode.
+    TCB2.CTRLB = (TCB2.CTRLB & ~TCB_CNTMODE_gm) | TCB_CNTMODE_INT_gc;
     // do not capture input events
     TCB2.EVCTRL &= ~TCB_CAPTEI_bm;
     // enable the counter
@@ -67,39 +132,79 @@ void RotaryListener::setup()
     // Clear the interrupt flag which may have been set while configuring the
     // timer (as the datasheet recommands).
     TCB2.INTFLAGS |= TCB_CAPT_bm;
+#endif
 }
 
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
 /**
-  * @return unsigned int The compare value of the TCB2 counter to use for having
-  * a period duration of PIN_POLL_DELAY_MS when the counter counts at
-  * XTAL Hz rate.
-  */
-unsigned int RotaryListener::getTcb2CompareValue()
+ * Called from the DTMF PWM ISR, on each sample. Counting them down is cheap
+ * enough for not delaying the next sample.
+ */
+void RotaryListener::handleTick()
 {
-    // convert to floats
-    const float _xtal = XTAL * 1.0;
-    const float _max_val = TCB2_MAX_VALUE * 1.0;
-    const float _delay = this->pinPollDelayMs * 1.0;
+    if (!this->countTick()) {
+        return;
+    }
 
-    // result of
-    // TCB2_MAX_VALUE * (PIN_POLL_DELAY_MS / (XTAL / TCB2_MAX_VALUE)) - 1
-    // -1 as the timer starts to count from 0
-    return (unsigned int) (_max_val * (_delay / (_xtal / _max_val))) -1;
-}
+#ifdef ENABLE_ISR_PROFILING
+    unsigned long startCycles = (unsigned long) DtmfGenerator::Timer::getCounter()
+        * DtmfGenerator::Timer::CLOCK_DIVIDER;
+#endif
+
+    this->handleIsr();
 
-// ISR triggered each pinPollDelayMs ms.
+#ifdef ENABLE_ISR_PROFILING
+    this->isrProfiler.record(
+        startCycles,
+        (unsigned long) DtmfGenerator::Timer::getCounter() * DtmfGenerator::Timer::CLOCK_DIVIDER
+    );
+#endif
+}
+#else
+// ISR triggered each pinPollDelayMs ms / getPollTicksCount, the pins being
+// polled every pinPollDelayMs ms.
 // The ISR callback is a static method.
 ISR(TCB2_INT_vect)
 {
+#ifdef ENABLE_ISR_PROFILING
+    // TCB2 counts at µC speed
+    unsigned long startCycles = TCB2.CNT;
+#endif
+
     RotaryListener* rotaryListener = RotaryListener::getInstance();
+    bool polled = nullptr != rotaryListener && rotaryListener->countTick();
 
-    if (nullptr != rotaryListener) {
+    if (polled) {
         rotaryListener->handleIsr();
     }
 
     // Clear the interrupt flag (i.e. indicates that the interrupt has been
     // handled. This is not done automatically).
     TCB2.INTFLAGS |= TCB_CAPT_bm;
+
+#ifdef ENABLE_ISR_PROFILING
+    // only the ticks polling the pins are profiled, the others merely count
+    if (polled) {
+        rotaryListener->getIsrProfiler()->record(startCycles, TCB2.CNT);
+    }
+#endif
+}
+#endif
+
+/**
+ * Count a period of the polling timer down.
+ *
+ * @return bool Whether the pins should be polled on this one.
+ */
+bool RotaryListener::countTick()
+{
+    if (0 != --this->remainingPollTicks) {
+        return false;
+    }
+
+    this->remainingPollTicks = this->pollTicksCount;
+
+    return true;
 }
 
 void RotaryListener::handleIsr()
@@ -110,21 +215,41 @@ void RotaryListener::handleIsr()
 
 void RotaryListener::pollPins()
 {
+    this->previousRotaryMovePinStatus = this->rotaryMovePinStatus;
     this->rotaryMovePinStatus = digitalRead(ROTARY_MOVE_PIN);
     this->previousPulsePinStatus = this->pulsePinStatus;
     this->pulsePinStatus = digitalRead(PULSE_PIN);
+
+#ifdef ENABLE_PIN_CAPTURE
+    this->pinCapture.record(this->rotaryMovePinStatus, this->pulsePinStatus);
+#endif
 }
 
 void RotaryListener::handlePinsStatuses()
 {
     if (!this->isRotaryMoving()) {
+#ifdef ENABLE_PIN_CAPTURE
+        if (this->hasRotaryBeenReleased() && 0 == this->pulsesCount) {
+            this->pinCapture.freeze(PIN_CAPTURE_ZERO_PULSE_RELEASE);
+        }
+#endif
+
         this->flushPulses();
+        this->windUpPollsCount = 0;
+        this->speedDial.handleIdlePoll(this->pinPollDelayMs);
 
         return;
     }
 
     if (this->isRotaryMoving() && this->hasPulseStarted()) {
         this->addPulse();
+
+        return;
+    }
+
+    // the rotary is wound up, or held at its finger stop
+    if (0 == this->pulsesCount && this->windUpPollsCount < 0xFFFF) {
+        ++this->windUpPollsCount;
     }
 }
 
@@ -145,18 +270,26 @@ void RotaryListener::flushPulses()
     // or wrong rotary pulse duration (supposed to be 66ms, with a pause of
     // 33ms between two pulses), or the kids are simply spinning the rotary for
     // a long time :p
-    if (this->pulsesCount > sizeof(rotaryDigits)) {
+    if (this->pulsesCount > sizeof(rotaryDigits) / sizeof(rotaryDigits[0])) {
         this->pulsesCount = 0;
 
+#ifdef ENABLE_PIN_CAPTURE
+        this->pinCapture.freeze(PIN_CAPTURE_PULSES_OVERFLOW);
+#endif
+
         return;
     }
 
     unsigned int dialedDigit = rotaryDigits[this->pulsesCount -1];
     this->pulsesCount = 0;
 
-    Serial.println((String)"Dialed digit " + dialedDigit);
+    LOG((String)"Dialed digit " + dialedDigit);
 
-    this->dialedDigit->push(dialedDigit);
+    // the speed dial tells the gestures apart, and queues the tones
+    this->speedDial.handleDigit(
+        dialedDigit,
+        (unsigned long) this->windUpPollsCount * this->pinPollDelayMs
+    );
 }
 
 bool RotaryListener::isRotaryMoving() const
@@ -164,6 +297,13 @@ bool RotaryListener::isRotaryMoving() const
     return LOW == this->rotaryMovePinStatus;
 }
 
+bool RotaryListener::hasRotaryBeenReleased() const
+{
+    return this->previousRotaryMovePinStatus != this->rotaryMovePinStatus
+        && HIGH == this->rotaryMovePinStatus
+    ;
+}
+
 bool RotaryListener::hasPulseStarted() const
 {
     return this->previousPulsePinStatus != this->pulsePinStatus
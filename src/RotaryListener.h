@@ -6,7 +6,17 @@
 // 0xFFFF, TCB2 is a 16bit counter.
 #define TCB2_MAX_VALUE 65535
 
+#include "Variables.h"
 #include "DialedDigit.h"
+#include "PwmTimer.h"
+#include "DtmfGenerator.h"
+#include "SpeedDial.h"
+#ifdef ENABLE_PIN_CAPTURE
+#include "PinCapture.h"
+#endif
+#ifdef ENABLE_ISR_PROFILING
+#include "IsrProfiler.h"
+#endif
 
 class RotaryListener
 {
@@ -18,6 +28,27 @@ class RotaryListener
         static RotaryListener* getInstance();
         void setup();
         void handleIsr();
+        bool countTick();
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
+        void handleTick();
+#endif
+        SpeedDial* getSpeedDial();
+#ifdef ENABLE_PIN_CAPTURE
+        PinCapture* getPinCapture();
+#endif
+#ifdef ENABLE_ISR_PROFILING
+        IsrProfiler* getIsrProfiler();
+#endif
+
+        /**
+         * @return double The actual period between two pins polls, in µs,
+         * as the timers can only approximate `pinPollDelayMs` ms.
+         */
+        static constexpr double getPollPeriodUs(unsigned int pinPollDelayMs)
+        {
+            return getPollTicksCount(pinPollDelayMs) * getPollTimerPeriodCycles(pinPollDelayMs)
+                * 1000000.0 / XTAL;
+        }
 
     private:
         RotaryListener(){};
@@ -32,16 +63,85 @@ class RotaryListener
         DialedDigit* dialedDigit;
         unsigned int pinPollDelayMs;
         unsigned int pulsesCount;
+        // how many polls the rotary has been moving before its first pulse
+        unsigned int windUpPollsCount;
+        unsigned char previousRotaryMovePinStatus;
         unsigned char rotaryMovePinStatus;
         unsigned char previousPulsePinStatus;
         unsigned char pulsePinStatus;
+        SpeedDial speedDial;
+        // after how many periods of the polling timer (i.e. ticks) the pins
+        // are polled, and how many remain until the next poll
+        unsigned int pollTicksCount;
+        unsigned int remainingPollTicks;
+#ifdef ENABLE_PIN_CAPTURE
+        PinCapture pinCapture;
+#endif
+#ifdef ENABLE_ISR_PROFILING
+        IsrProfiler isrProfiler;
+#endif
+
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
+        /**
+         * @return unsigned long After how many DTMF PWM periods (i.e. ticks)
+         * the pins should be polled to approach `pinPollDelayMs` ms.
+         */
+        static constexpr unsigned long getPollTicksCount(unsigned int pinPollDelayMs)
+        {
+            return (unsigned long) (
+                1.0 * DtmfGenerator::PERIOD_FREQUENCY * pinPollDelayMs / 1000 + 0.5
+            );
+        }
+
+        /**
+         * @return unsigned long The period of the timer triggering the poll
+         * ISR, in µC cycles.
+         */
+        static constexpr unsigned long getPollTimerPeriodCycles(unsigned int /* pinPollDelayMs */)
+        {
+            return (DtmfGenerator::PWM_MAX_VALUE + 1UL) * DtmfGenerator::Timer::CLOCK_DIVIDER;
+        }
+#else
+        /**
+         * @return unsigned long After how many TCB2 periods (i.e. ticks) the
+         * pins should be polled, as the 16bit counter can't count up to
+         * `pinPollDelayMs` ms at µC speed.
+         */
+        static constexpr unsigned long getPollTicksCount(unsigned int pinPollDelayMs)
+        {
+            // rounded up, so that a period fits in the counter
+            return ((unsigned long) XTAL / 1000 * pinPollDelayMs + TCB2_MAX_VALUE)
+                / (TCB2_MAX_VALUE + 1UL);
+        }
+
+        /**
+         * @return unsigned long The compare value of the TCB2 counter to use
+         * for having `getPollTicksCount` periods last `pinPollDelayMs` ms, the
+         * counter counting at µC speed.
+         */
+        static constexpr unsigned long getTcb2CompareValue(unsigned int pinPollDelayMs)
+        {
+            // -1 as the timer starts to count from 0
+            return (unsigned long) XTAL / 1000 * pinPollDelayMs
+                / getPollTicksCount(pinPollDelayMs) - 1;
+        }
+
+        /**
+         * @return unsigned long The period of the timer triggering the poll
+         * ISR, in µC cycles.
+         */
+        static constexpr unsigned long getPollTimerPeriodCycles(unsigned int pinPollDelayMs)
+        {
+            return getTcb2CompareValue(pinPollDelayMs) + 1;
+        }
+#endif
 
-        unsigned int getTcb2CompareValue();
         void pollPins();
         void handlePinsStatuses();
         void addPulse();
         void flushPulses();
         bool isRotaryMoving() const;
+        bool hasRotaryBeenReleased() const;
         bool hasPulseStarted() const;
 };
 
@@ -0,0 +1,190 @@
+#include "Variables.h"
+#include "SpeedDial.h"
+#include "DialedDigit.h"
+#include "Log.h"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+SpeedDial::SpeedDial(DialedDigit* dialedDigit)
+:   dialedDigit(dialedDigit),
+    recordingSlot(SPEED_DIAL_NO_SLOT),
+    recordedDigitsCount(0),
+    recordingIdleMs(0),
+    pendingStoreSlot(SPEED_DIAL_NO_SLOT)
+{
+    static_assert(
+        SPEED_DIAL_EEPROM_ADDRESS + SPEED_DIAL_SLOTS_COUNT * SPEED_DIAL_SLOT_SIZE <= EEPROM_SIZE,
+        "The speed dial slots do not fit in EEPROM."
+    );
+    static_assert(
+        SPEED_DIAL_DIGITS_COUNT < DIALED_DIGITS_QUEUE_SIZE,
+        "A speed dial number should fit in the dialed digits queue."
+    );
+    static_assert(
+        SPEED_DIAL_HOLD_MS < SPEED_DIAL_STORE_HOLD_MS,
+        "The speed dial store hold should be longer than the play one."
+    );
+    static_assert(
+        SPEED_DIAL_RECORD_TIMEOUT_MS <= 0xFFFF - PIN_POLL_DELAY_MS,
+        "The speed dial record timeout should fit in a 16bit int."
+    );
+}
+
+/**
+ * Called from the rotary ISR for each dialed digit, instead of queueing its
+ * tone.
+ *
+ * @param holdMs How long the rotary has been away from its rest position
+ * before its first pulse.
+ */
+void SpeedDial::handleDigit(unsigned int digit, unsigned long holdMs)
+{
+    this->recordingIdleMs = 0;
+
+    if (holdMs >= SPEED_DIAL_STORE_HOLD_MS) {
+        this->recordingSlot = digit;
+        this->recordedDigitsCount = 0;
+
+        LOG((String) "Recording speed dial " + digit);
+
+        return;
+    }
+
+    if (holdMs >= SPEED_DIAL_HOLD_MS) {
+        if (SPEED_DIAL_NO_SLOT == this->recordingSlot) {
+            // an empty slot dials its digit, as if it had not been held
+            if (!this->play(digit)) {
+                this->dialedDigit->push(digit);
+            }
+
+            return;
+        }
+
+        // writing the EEPROM takes ms per byte, which is done from the main
+        // loop rather than from here
+        this->pendingStoreSlot = this->recordingSlot;
+        this->recordingSlot = SPEED_DIAL_NO_SLOT;
+
+        return;
+    }
+
+    if (SPEED_DIAL_NO_SLOT != this->recordingSlot) {
+        // the digits beyond the slot capacity are ignored
+        if (this->recordedDigitsCount < SPEED_DIAL_DIGITS_COUNT) {
+            this->recordedDigits[this->recordedDigitsCount++] = digit;
+        }
+
+        return;
+    }
+
+    this->dialedDigit->push(digit);
+}
+
+/**
+ * Called from the rotary ISR on each poll while the rotary is at rest, to
+ * cancel a forgotten recording, which would swallow all the next digits.
+ */
+void SpeedDial::handleIdlePoll(unsigned int pollDelayMs)
+{
+    if (SPEED_DIAL_NO_SLOT == this->recordingSlot) {
+        return;
+    }
+
+    this->recordingIdleMs += pollDelayMs;
+
+    if (this->recordingIdleMs >= SPEED_DIAL_RECORD_TIMEOUT_MS) {
+        LOG((String) "Speed dial " + (int) this->recordingSlot + " recording timed out");
+
+        this->recordingSlot = SPEED_DIAL_NO_SLOT;
+    }
+}
+
+/**
+ * Write the recorded digits to their slot, if the recording is over. Meant to
+ * be called from the main loop.
+ */
+void SpeedDial::storeIfPending()
+{
+    if (SPEED_DIAL_NO_SLOT == this->pendingStoreSlot) {
+        return;
+    }
+
+    unsigned char digits[SPEED_DIAL_DIGITS_COUNT];
+
+    // a new recording must not start while the digits are copied
+    cli();
+
+    const unsigned char slot = this->pendingStoreSlot;
+    const unsigned char digitsCount = this->recordedDigitsCount;
+
+    for (unsigned char i = 0; i < digitsCount; i++) {
+        digits[i] = this->recordedDigits[i];
+    }
+
+    this->pendingStoreSlot = SPEED_DIAL_NO_SLOT;
+
+    sei();
+
+    const unsigned int address = getSlotAddress(slot);
+
+    // update rather than write, to spare the EEPROM cells
+    EEPROM.update(address, digitsCount);
+
+    for (unsigned char i = 0; i < digitsCount; i++) {
+        EEPROM.update(address + 1 + i, digits[i]);
+    }
+
+    LOG((String) "Stored " + digitsCount + " digits in speed dial " + slot);
+}
+
+/**
+ * @return bool Whether the slot holds a valid number, which is queued when
+ * there is room for all its digits.
+ */
+bool SpeedDial::play(unsigned char slot)
+{
+    const unsigned int address = getSlotAddress(slot);
+    const unsigned char digitsCount = EEPROM.read(address);
+    unsigned char digits[SPEED_DIAL_DIGITS_COUNT];
+
+    // an erased EEPROM reads 0xFF
+    if (0 == digitsCount || digitsCount > SPEED_DIAL_DIGITS_COUNT) {
+        LOG((String) "Speed dial " + slot + " is empty");
+
+        return false;
+    }
+
+    // a partly written or corrupted slot must not reach the tones table
+    for (unsigned char i = 0; i < digitsCount; i++) {
+        digits[i] = EEPROM.read(address + 1 + i);
+
+        if (digits[i] > SPEED_DIAL_MAX_DIGIT) {
+            LOG((String) "Speed dial " + slot + " is corrupted");
+
+            return false;
+        }
+    }
+
+    // rather than a truncated number
+    if (this->dialedDigit->getFreeCount() < digitsCount) {
+        LOG((String) "No room to play speed dial " + slot);
+
+        return true;
+    }
+
+    LOG((String) "Playing speed dial " + slot);
+
+    for (unsigned char i = 0; i < digitsCount; i++) {
+        this->dialedDigit->push(digits[i], true);
+    }
+
+    return true;
+}
+
+unsigned int SpeedDial::getSlotAddress(unsigned char slot)
+{
+    return SPEED_DIAL_EEPROM_ADDRESS + slot * SPEED_DIAL_SLOT_SIZE;
+}
@@ -0,0 +1,49 @@
+#ifndef S63_SPEEDDIAL_H
+#define S63_SPEEDDIAL_H
+
+#include "DialedDigit.h"
+
+// one slot per rotary digit
+#define SPEED_DIAL_SLOTS_COUNT 10
+#define SPEED_DIAL_DIGITS_COUNT 16
+// where the slots start in EEPROM
+#define SPEED_DIAL_EEPROM_ADDRESS 0
+// a slot is its digits count (1 byte) followed by its digits (1 byte each)
+#define SPEED_DIAL_SLOT_SIZE (1 + SPEED_DIAL_DIGITS_COUNT)
+#define SPEED_DIAL_NO_SLOT -1
+// the highest digit a rotary can dial, and so store
+#define SPEED_DIAL_MAX_DIGIT 9
+
+/**
+ * Numbers stored in EEPROM, played back as a burst of tones at the minimal
+ * timings (see DTMF_BURST_DURATION_MS) instead of being dialed digit by digit.
+ *
+ * The rotary gestures are told apart by how long the rotary has been held
+ * before its first pulse (see SPEED_DIAL_HOLD_MS) : a short hold plays the
+ * number stored in the slot of the dialed digit (or dials the digit when the
+ * slot is empty), a long one records the next dialed digits in it, until the
+ * next short hold or SPEED_DIAL_RECORD_TIMEOUT_MS without dialing.
+ */
+class SpeedDial
+{
+    public:
+        SpeedDial(DialedDigit* dialedDigit = nullptr);
+
+        void handleDigit(unsigned int digit, unsigned long holdMs);
+        void handleIdlePoll(unsigned int pollDelayMs);
+        void storeIfPending();
+
+    private:
+        DialedDigit* dialedDigit;
+        signed char recordingSlot;
+        unsigned char recordedDigits[SPEED_DIAL_DIGITS_COUNT];
+        unsigned char recordedDigitsCount;
+        // how long the rotary has been at rest while recording, in ms
+        unsigned int recordingIdleMs;
+        volatile signed char pendingStoreSlot;
+
+        bool play(unsigned char slot);
+        static unsigned int getSlotAddress(unsigned char slot);
+};
+
+#endif
@@ -1,12 +1,64 @@
 #ifndef S63_VARIABLES_H
 #define S63_VARIABLES_H
 
-// µC freq. configured by default to 16MHz by arduino-cli's boards.txt.
+// µC freq. configured by default to 16MHz by arduino-cli's boards.txt, which
+// defines it as F_CPU.
+#ifndef XTAL
+#ifdef F_CPU
+#define XTAL F_CPU
+#else
 #define XTAL 16000000
+#endif
+#endif
 // You may want to lower this value if you have difficulties to determine the
 // rotary pulses count. Do not exceed 25.
+#ifndef PIN_POLL_DELAY_MS
 #define PIN_POLL_DELAY_MS 20
+#endif
 // how long the tone should be played, in ms
+#ifndef DTMF_DURATION_MS
 #define DTMF_DURATION_MS 300
+#endif
+// How long the tones of a speed dial burst last, and the minimal quiet time
+// between two tones, in ms. ITU-T Q.24 receivers must recognize tones and
+// pauses of 40ms.
+#ifndef DTMF_BURST_DURATION_MS
+#define DTMF_BURST_DURATION_MS 45
+#endif
+#ifndef DTMF_PAUSE_MS
+#define DTMF_PAUSE_MS 45
+#endif
+// Holding the rotary at its finger stop for this long (in ms) before releasing
+// it plays the number stored in the speed dial slot of the dialed digit. The
+// hold is counted from the rotary leaving its rest position, so it must stay
+// above the slowest wind up of a normal dialing (about 0.5s for a 0).
+#ifndef SPEED_DIAL_HOLD_MS
+#define SPEED_DIAL_HOLD_MS 1000
+#endif
+// Holding it for this long records the next dialed digits in the slot instead,
+// until the next SPEED_DIAL_HOLD_MS hold (of any digit).
+#ifndef SPEED_DIAL_STORE_HOLD_MS
+#define SPEED_DIAL_STORE_HOLD_MS 5000
+#endif
+// A recording is cancelled once the rotary has stayed at rest for this long
+// (in ms), the slot being left untouched.
+#ifndef SPEED_DIAL_RECORD_TIMEOUT_MS
+#define SPEED_DIAL_RECORD_TIMEOUT_MS 15000
+#endif
+// The timer generating the DTMF output PWM is TCB1 (8bit PWM only, output on
+// pin D3), unless DTMF_PWM_TIMER_TCA0 is defined (up to 15bit PWM, output on
+// pin D9). Using TCA0 makes it count at µC speed, and the Arduino core counts
+// millis() on the TCA0 clock : millis(), micros() and delay() then run 64 times
+// too fast (see MILLIS_SPEEDUP).
+// The resolution of the DTMF output PWM, in bits. The higher it is, the lower
+// the sample rate (i.e. µC freq. / 2^resolution).
+#ifndef DTMF_PWM_RESOLUTION_BITS
+#define DTMF_PWM_RESOLUTION_BITS 8
+#endif
+// The rotary pins are polled from a dedicated TCB2 ISR, unless
+// ROTARY_POLL_ON_DTMF_TIMER is defined : the DTMF PWM ISR then counts the
+// samples, and polls the pins every PIN_POLL_DELAY_MS worth of them. This
+// frees TCB2, and the polling can't delay a sample anymore (nor the other way
+// around).
 
 #endif
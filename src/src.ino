@@ -2,9 +2,11 @@
 #include "DialedDigit.h"
 #include "RotaryListener.h"
 #include "DtmfGenerator.h"
+#include "SpeedDial.h"
+#include "PwmTimer.h"
 
 void setup() {
-#ifdef ENABLE_LOGGING
+#if defined(ENABLE_LOGGING) || defined(ENABLE_PIN_CAPTURE) || defined(ENABLE_ISR_PROFILING)
     Serial.begin(9600);
 #endif
 
@@ -24,5 +26,29 @@ void loop() {
     // `delay` calls here as it would pause the program (e.g. pause the DTMF
     // generation).
 
-    while(1); // gets rid of jitter
+    // The speed dial numbers, the capture and the ISRs profiles are written
+    // from here as it takes way longer than a polling period, the ISRs keep
+    // running meanwhile.
+    SpeedDial* speedDial = RotaryListener::getInstance()->getSpeedDial();
+#ifdef ENABLE_PIN_CAPTURE
+    PinCapture* pinCapture = RotaryListener::getInstance()->getPinCapture();
+#endif
+#ifdef ENABLE_ISR_PROFILING
+    unsigned long lastReportMs = millis();
+#endif
+
+    while(1) {
+        speedDial->storeIfPending();
+#ifdef ENABLE_PIN_CAPTURE
+        pinCapture->exportIfFrozen();
+#endif
+#ifdef ENABLE_ISR_PROFILING
+        if (millis() - lastReportMs >= ISR_PROFILING_REPORT_DELAY_MS * MILLIS_SPEEDUP) {
+            lastReportMs = millis();
+
+            DtmfGenerator::getInstance()->getIsrProfiler()->report("DTMF");
+            RotaryListener::getInstance()->getIsrProfiler()->report("Rotary poll");
+        }
+#endif
+    }
 }
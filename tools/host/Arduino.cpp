@@ -0,0 +1,119 @@
+#include "Simulator.h"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <string.h>
+
+void pinMode(uint8_t /* pin */, uint8_t /* mode */)
+{
+    // the pins levels are entirely driven by the Simulator
+}
+
+int digitalRead(uint8_t pin)
+{
+    return Simulator::getInstance()->readPin(pin);
+}
+
+String::String(const char* value): value(value)
+{}
+
+String::String(const std::string& value): value(value)
+{}
+
+const char* String::c_str() const
+{
+    return this->value.c_str();
+}
+
+String String::operator+(const char* value) const
+{
+    return String(this->value + value);
+}
+
+String String::operator+(int value) const
+{
+    return String(this->value + std::to_string(value));
+}
+
+String String::operator+(unsigned int value) const
+{
+    return String(this->value + std::to_string(value));
+}
+
+String String::operator+(long value) const
+{
+    return String(this->value + std::to_string(value));
+}
+
+String String::operator+(unsigned long value) const
+{
+    return String(this->value + std::to_string(value));
+}
+
+HardwareSerial Serial;
+
+HardwareSerial::HardwareSerial(): enabled(false), output(nullptr)
+{}
+
+void HardwareSerial::begin(unsigned long /* baudRate */)
+{
+    this->enabled = true;
+}
+
+void HardwareSerial::setOutput(FILE* output)
+{
+    this->output = output;
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    if (!this->enabled) {
+        return 0;
+    }
+
+    return fwrite(&value, 1, 1, nullptr == this->output ? stderr : this->output);
+}
+
+size_t HardwareSerial::write(const char* value)
+{
+    size_t written = 0;
+
+    while ('\0' != *value) {
+        written += this->write((uint8_t) *value++);
+    }
+
+    return written;
+}
+
+void HardwareSerial::println(const char* value)
+{
+    this->write(value);
+    this->write('\n');
+}
+
+void HardwareSerial::println(const String& value)
+{
+    this->println(value.c_str());
+}
+
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass()
+{
+    memset(this->bytes, 0xFF, sizeof(this->bytes));
+}
+
+uint8_t EEPROMClass::read(int index) const
+{
+    return this->bytes[index];
+}
+
+void EEPROMClass::update(int index, uint8_t value)
+{
+    this->bytes[index] = value;
+}
+
+uint16_t EEPROMClass::length() const
+{
+    return EEPROM_SIZE;
+}
@@ -0,0 +1,124 @@
+#include "DialScript.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @param dtmfDurationMs How long the firmware plays a tone, in order to wait
+ * for its end before dialing the next digit.
+ */
+DialScript::DialScript(
+    Simulator* simulator,
+    RotaryDial* rotaryDial,
+    unsigned int dtmfDurationMs
+):  simulator(simulator),
+    rotaryDial(rotaryDial),
+    dtmfDurationMs(dtmfDurationMs),
+    cursorCycle(0),
+    windUpMs(DIAL_SCRIPT_WIND_UP_MS),
+    releaseDelayMs(DIAL_SCRIPT_RELEASE_DELAY_MS),
+    gapMs(DIAL_SCRIPT_GAP_MS),
+    dialCallback(nullptr),
+    dialCallbackContext(nullptr)
+{}
+
+/**
+ * Parse a script line and schedule it. The cursor can't be in the past of the
+ * virtual clock : a command received late starts right away.
+ *
+ * @return bool Whether the line is valid, `error` being filled otherwise.
+ */
+bool DialScript::execute(const char* line, std::string* error)
+{
+    char command[16], argument[64], trailing[2];
+    int argumentsCount = sscanf(line, "%15s %63s %1s", command, argument, trailing);
+
+    // blank line or comment
+    if (argumentsCount < 1 || '#' == command[0]) {
+        return true;
+    }
+
+    if (2 != argumentsCount) {
+        *error = (std::string) "expected a command and a single argument, got \"" + line + "\"";
+
+        return false;
+    }
+
+    if (this->cursorCycle < this->simulator->now()) {
+        this->cursorCycle = this->simulator->now();
+    }
+
+    if (0 == strcmp(command, "dial")) {
+        for (const char* digit = argument; '\0' != *digit; digit++) {
+            if (!isdigit(*digit)) {
+                *error = (std::string) "a rotary can't dial \"" + *digit + "\"";
+
+                return false;
+            }
+        }
+
+        for (const char* digit = argument; '\0' != *digit; digit++) {
+            this->dial(*digit - '0');
+        }
+
+        return true;
+    }
+
+    char* end;
+    unsigned long ms = strtoul(argument, &end, 10);
+
+    if ('\0' != *end || '-' == argument[0]) {
+        *error = (std::string) "expected a duration in ms, got \"" + argument + "\"";
+
+        return false;
+    }
+
+    if (0 == strcmp(command, "wait")) {
+        this->cursorCycle += this->simulator->msToCycles(ms);
+    } else if (0 == strcmp(command, "windup")) {
+        this->windUpMs = ms;
+    } else if (0 == strcmp(command, "release")) {
+        this->releaseDelayMs = ms;
+    } else if (0 == strcmp(command, "gap")) {
+        this->gapMs = ms;
+    } else {
+        *error = (std::string) "unknown command \"" + command + "\"";
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @return unsigned long long When the last scheduled command ends.
+ */
+unsigned long long DialScript::getCursorCycle() const
+{
+    return this->cursorCycle;
+}
+
+void DialScript::onDial(DialCallback callback, void* context)
+{
+    this->dialCallback = callback;
+    this->dialCallbackContext = context;
+}
+
+void DialScript::dial(unsigned int digit)
+{
+    DialTimeline timeline = this->rotaryDial->dial(
+        this->cursorCycle,
+        digit,
+        this->windUpMs,
+        this->releaseDelayMs
+    );
+
+    this->cursorCycle = timeline.releaseCycle
+        + this->simulator->msToCycles(this->dtmfDurationMs + this->gapMs)
+    ;
+
+    if (nullptr != this->dialCallback) {
+        this->dialCallback(digit, timeline, this->dialCallbackContext);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef S63_HOST_DIALSCRIPT_H
+#define S63_HOST_DIALSCRIPT_H
+
+#include "Simulator.h"
+#include "RotaryDial.h"
+
+#include <string>
+
+// the default timings of a dialing, in ms
+#define DIAL_SCRIPT_WIND_UP_MS 200
+#define DIAL_SCRIPT_RELEASE_DELAY_MS 30
+// the quiet time between the end of a tone and the next dialing
+#define DIAL_SCRIPT_GAP_MS 100
+
+/**
+ * Called for each dialed digit, once its pins changes have been scheduled.
+ */
+typedef void (*DialCallback)(
+    unsigned int digit,
+    const DialTimeline& timeline,
+    void* context
+);
+
+/**
+ * Dials on a simulated S63 rotary the digits of a script, one command per
+ * line :
+ *
+ * # a comment
+ * dial 0123456789   dial the digits, each one once the previous tone is over
+ * wait 500          stay on hook for 500ms
+ * windup 250        wind the rotary up for 250ms before its first pulse
+ * release 40        reach the rest position 40ms after the last pulse
+ * gap 150           wait 150ms after a tone before dialing the next digit
+ *
+ * The commands are scheduled one after the other, from the cursor : the
+ * virtual clock cycle at which the previous command ends.
+ */
+class DialScript
+{
+    public:
+        DialScript(
+            Simulator* simulator,
+            RotaryDial* rotaryDial,
+            unsigned int dtmfDurationMs
+        );
+
+        bool execute(const char* line, std::string* error);
+        unsigned long long getCursorCycle() const;
+        void onDial(DialCallback callback, void* context);
+
+    private:
+        Simulator* simulator;
+        RotaryDial* rotaryDial;
+        unsigned int dtmfDurationMs;
+        unsigned long long cursorCycle;
+        unsigned int windUpMs;
+        unsigned int releaseDelayMs;
+        unsigned int gapMs;
+        DialCallback dialCallback;
+        void* dialCallbackContext;
+
+        void dial(unsigned int digit);
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "PcmBuffer.h"
+
+#include <algorithm>
+
+/**
+ * @param capacity How many samples the buffer holds before dropping the
+ * oldest ones.
+ */
+PcmBuffer::PcmBuffer(unsigned int capacity)
+:   samples(capacity),
+    pushedCount(0),
+    consumedCount(0),
+    droppedCount(0)
+{}
+
+void PcmBuffer::push(short sample)
+{
+    if (this->pushedCount - this->consumedCount == this->samples.size()) {
+        ++this->consumedCount;
+        ++this->droppedCount;
+    }
+
+    this->samples[this->pushedCount++ % this->samples.size()] = sample;
+}
+
+/**
+ * @return const short* The oldest samples, `count` being how many are
+ * contiguous in memory.
+ */
+const short* PcmBuffer::peek(unsigned int* count) const
+{
+    unsigned int start = this->consumedCount % this->samples.size();
+    unsigned long long buffered = this->pushedCount - this->consumedCount;
+
+    *count = std::min((unsigned long long) (this->samples.size() - start), buffered);
+
+    return &this->samples[start];
+}
+
+void PcmBuffer::consume(unsigned int count)
+{
+    this->consumedCount += count;
+}
+
+unsigned long long PcmBuffer::size() const
+{
+    return this->pushedCount - this->consumedCount;
+}
+
+/**
+ * @return unsigned long long The index of the oldest sample since the start
+ * of the stream.
+ */
+unsigned long long PcmBuffer::getConsumedCount() const
+{
+    return this->consumedCount;
+}
+
+unsigned long long PcmBuffer::getDroppedCount() const
+{
+    return this->droppedCount;
+}
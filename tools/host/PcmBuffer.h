@@ -0,0 +1,30 @@
+#ifndef S63_HOST_PCMBUFFER_H
+#define S63_HOST_PCMBUFFER_H
+
+#include <vector>
+
+/**
+ * Bounded FIFO of PCM samples, between the simulation and the consumer. When
+ * full, the oldest samples are dropped : the stream stays real time rather
+ * than lagging behind.
+ */
+class PcmBuffer
+{
+    public:
+        PcmBuffer(unsigned int capacity);
+
+        void push(short sample);
+        const short* peek(unsigned int* count) const;
+        void consume(unsigned int count);
+        unsigned long long size() const;
+        unsigned long long getConsumedCount() const;
+        unsigned long long getDroppedCount() const;
+
+    private:
+        std::vector<short> samples;
+        unsigned long long pushedCount;
+        unsigned long long consumedCount;
+        unsigned long long droppedCount;
+};
+
+#endif
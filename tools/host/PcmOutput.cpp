@@ -0,0 +1,188 @@
+#include "PcmOutput.h"
+#include "UnixSocket.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+PcmOutput::PcmOutput()
+:   listeningFd(-1),
+    fd(-1),
+    ptySlaveFd(-1),
+    gone(false),
+    inherited(false)
+{}
+
+/**
+ * @param target '-' for stdout, 'pty' for a new pseudo terminal, or
+ * 'unix:PATH' to listen on a UNIX socket (see acceptClient).
+ * @return bool Whether the output is ready, `error` being filled otherwise.
+ */
+bool PcmOutput::open(const char* target, std::string* error)
+{
+    if (0 == strcmp(target, "-")) {
+        this->fd = STDOUT_FILENO;
+        this->inherited = true;
+
+        return true;
+    }
+
+    if (0 == strcmp(target, "pty")) {
+        return this->openPty(error);
+    }
+
+    if (0 == strncmp(target, "unix:", 5)) {
+        this->listeningFd = listenUnixSocket(target + 5);
+
+        if (-1 == this->listeningFd) {
+            *error = (std::string) "Unable to listen on \"" + (target + 5) + "\" : " + strerror(errno) + ".";
+
+            return false;
+        }
+
+        return true;
+    }
+
+    *error = (std::string) "Invalid output \"" + target + "\".";
+
+    return false;
+}
+
+bool PcmOutput::isListening() const
+{
+    return -1 != this->listeningFd;
+}
+
+/**
+ * Wait up to `timeoutMs` ms for a client of the UNIX socket, when none is
+ * connected.
+ *
+ * @return bool Whether a client is connected.
+ */
+bool PcmOutput::acceptClient(int timeoutMs)
+{
+    if (-1 != this->fd || -1 == this->listeningFd) {
+        return this->isConnected();
+    }
+
+    struct pollfd pollFd = { this->listeningFd, POLLIN, 0 };
+
+    if (poll(&pollFd, 1, timeoutMs) <= 0) {
+        return false;
+    }
+
+    this->fd = accept(this->listeningFd, NULL, NULL);
+
+    if (-1 == this->fd) {
+        return false;
+    }
+
+    setNonBlocking(this->fd);
+    fprintf(stderr, "Stream client connected.\n");
+
+    return true;
+}
+
+bool PcmOutput::isConnected() const
+{
+    return -1 != this->fd;
+}
+
+bool PcmOutput::isGone() const
+{
+    return this->gone;
+}
+
+/**
+ * @return unsigned int How many samples the consumer has accepted.
+ */
+unsigned int PcmOutput::write(const short* samples, unsigned int count)
+{
+    if (-1 == this->fd) {
+        this->acceptClient(0);
+
+        return 0;
+    }
+
+    if (this->inherited) {
+        struct pollfd pollFd = { this->fd, POLLOUT, 0 };
+
+        if (0 == poll(&pollFd, 1, 0)) {
+            return 0;
+        }
+
+        // a writable pipe accepts PIPE_BUF bytes without blocking
+        count = std::min(count, (unsigned int) (PIPE_BUF / sizeof(short)));
+    }
+
+    ssize_t written = ::write(this->fd, samples, count * sizeof(short));
+
+    if (-1 == written) {
+        if (EAGAIN != errno && EWOULDBLOCK != errno) {
+            this->disconnect();
+        }
+
+        return 0;
+    }
+
+    // a sample may have been half written, its remaining byte is sent
+    // blocking in order to keep the samples aligned
+    if (0 != written % sizeof(short)) {
+        int flags = fcntl(this->fd, F_GETFL);
+
+        fcntl(this->fd, F_SETFL, flags & ~O_NONBLOCK);
+        ::write(this->fd, (const char*) samples + written, 1);
+        fcntl(this->fd, F_SETFL, flags);
+        ++written;
+    }
+
+    return written / sizeof(short);
+}
+
+bool PcmOutput::openPty(std::string* error)
+{
+    struct termios attributes;
+
+    this->fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (-1 == this->fd || -1 == grantpt(this->fd) || -1 == unlockpt(this->fd)) {
+        *error = (std::string) "Unable to open a pseudo terminal : " + strerror(errno) + ".";
+
+        return false;
+    }
+
+    // the samples must go through untouched
+    this->ptySlaveFd = ::open(ptsname(this->fd), O_RDWR | O_NOCTTY);
+    tcgetattr(this->ptySlaveFd, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(this->ptySlaveFd, TCSANOW, &attributes);
+
+    setNonBlocking(this->fd);
+
+    fprintf(stderr, "Streaming on %s\n", ptsname(this->fd));
+
+    return true;
+}
+
+void PcmOutput::disconnect()
+{
+    if (-1 == this->listeningFd) {
+        fprintf(stderr, "The stream consumer has gone away.\n");
+        this->gone = true;
+
+        return;
+    }
+
+    close(this->fd);
+    this->fd = -1;
+
+    fprintf(stderr, "Stream client disconnected.\n");
+}
@@ -0,0 +1,38 @@
+#ifndef S63_HOST_PCMOUTPUT_H
+#define S63_HOST_PCMOUTPUT_H
+
+#include <string>
+
+/**
+ * The consumer side of the stream : stdout, a pseudo terminal, or the client
+ * of a UNIX socket, one after the other. All writes are non blocking : stdout
+ * being shared with the parent process, it is polled rather than switched to
+ * non blocking mode.
+ */
+class PcmOutput
+{
+    public:
+        PcmOutput();
+
+        bool open(const char* target, std::string* error);
+        bool isListening() const;
+        bool acceptClient(int timeoutMs);
+        bool isConnected() const;
+        bool isGone() const;
+        unsigned int write(const short* samples, unsigned int count);
+
+    private:
+        int listeningFd;
+        int fd;
+        // kept open, so that the writes do not fail while no one reads
+        int ptySlaveFd;
+        // stdout or the pseudo terminal has been closed by the consumer
+        bool gone;
+        // the descriptor is inherited, its flags are left untouched
+        bool inherited;
+
+        bool openPty(std::string* error);
+        void disconnect();
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "PcmResampler.h"
+
+#include <math.h>
+
+// the quality factors of the two biquads of a 4th order Butterworth filter
+static const double butterworthQs[PCM_RESAMPLER_BIQUADS_COUNT] = {
+    0.54119610014619701,
+    1.3065629648763764
+};
+
+/**
+ * @param inputRate The PWM sample rate, in Hz.
+ * @param outputRate The PCM sample rate, in Hz.
+ * @param cutoffFrequency The cutoff frequency of the low pass filter, in Hz.
+ * @param midpointDutyCycle The duty cycle of the rest level, which becomes 0.
+ * @param maxDutyCycle The max value of the PWM counter.
+ */
+PcmResampler::PcmResampler(
+    double inputRate,
+    double outputRate,
+    double cutoffFrequency,
+    unsigned int midpointDutyCycle,
+    unsigned int maxDutyCycle
+):  inputRate(inputRate),
+    outputRate(outputRate),
+    midpointDutyCycle(midpointDutyCycle),
+    halfRange((maxDutyCycle + 1) / 2.0 / PCM_RESAMPLER_GAIN),
+    previousValue(0),
+    inputsCount(0),
+    outputsCount(0)
+{
+    for (unsigned int i = 0; i < PCM_RESAMPLER_BIQUADS_COUNT; i++) {
+        setupLowPass(&this->biquads[i], inputRate, cutoffFrequency, butterworthQs[i]);
+    }
+}
+
+/**
+ * Push the duty cycle of the next PWM period.
+ *
+ * @return unsigned int How many PCM samples have been written to `output`
+ * (0 when downsampling between two PCM samples).
+ */
+unsigned int PcmResampler::push(
+    unsigned int dutyCycle,
+    short* output,
+    unsigned int outputSize
+)
+{
+    double value = (dutyCycle - this->midpointDutyCycle) / this->halfRange;
+
+    for (unsigned int i = 0; i < PCM_RESAMPLER_BIQUADS_COUNT; i++) {
+        value = filter(&this->biquads[i], value);
+    }
+
+    unsigned int written = 0;
+
+    // the PCM samples falling between the previous input sample and this one,
+    // in input samples units
+    while (written < outputSize) {
+        double position = this->outputsCount * this->inputRate / this->outputRate;
+
+        if (position > this->inputsCount) {
+            break;
+        }
+
+        double fraction = 1.0 - (this->inputsCount - position);
+
+        if (0 == this->inputsCount) {
+            fraction = 1.0;
+        }
+
+        output[written++] = toPcm(
+            this->previousValue + (value - this->previousValue) * fraction
+        );
+        ++this->outputsCount;
+    }
+
+    this->previousValue = value;
+    ++this->inputsCount;
+
+    return written;
+}
+
+/**
+ * Low pass biquad coefficients.
+ * @see https://www.w3.org/TR/audio-eq-cookbook/
+ */
+void PcmResampler::setupLowPass(
+    Biquad* biquad,
+    double sampleRate,
+    double cutoffFrequency,
+    double q
+)
+{
+    const double w0 = 2 * M_PI * cutoffFrequency / sampleRate;
+    const double alpha = sin(w0) / (2 * q);
+    const double a0 = 1 + alpha;
+
+    biquad->b0 = (1 - cos(w0)) / 2 / a0;
+    biquad->b1 = (1 - cos(w0)) / a0;
+    biquad->b2 = biquad->b0;
+    biquad->a1 = -2 * cos(w0) / a0;
+    biquad->a2 = (1 - alpha) / a0;
+    biquad->z1 = 0;
+    biquad->z2 = 0;
+}
+
+// transposed direct form II
+double PcmResampler::filter(Biquad* biquad, double value)
+{
+    double filtered = biquad->b0 * value + biquad->z1;
+
+    biquad->z1 = biquad->b1 * value - biquad->a1 * filtered + biquad->z2;
+    biquad->z2 = biquad->b2 * value - biquad->a2 * filtered;
+
+    return filtered;
+}
+
+short PcmResampler::toPcm(double value)
+{
+    long sample = lround(value * 32767);
+
+    if (sample > 32767) {
+        return 32767;
+    }
+
+    if (sample < -32768) {
+        return -32768;
+    }
+
+    return sample;
+}
@@ -0,0 +1,64 @@
+#ifndef S63_HOST_PCMRESAMPLER_H
+#define S63_HOST_PCMRESAMPLER_H
+
+// the low pass filter is a 4th order Butterworth, i.e. two biquads
+#define PCM_RESAMPLER_BIQUADS_COUNT 2
+// The full PWM range is scaled to half the PCM range (-6dB). A full swing
+// tone would otherwise clip on the overshoot of the filter.
+#define PCM_RESAMPLER_GAIN 0.5
+
+/**
+ * Converts the duty cycles of the DTMF output PWM into signed 16bit PCM
+ * samples, as the low pass filter of the board turns the PWM into audio.
+ *
+ * The duty cycles are centered on the PWM midpoint (the rest level), scaled to
+ * [-PCM_RESAMPLER_GAIN, PCM_RESAMPLER_GAIN], low pass filtered at the PWM
+ * sample rate, and then linearly interpolated at the PCM sample rate.
+ */
+class PcmResampler
+{
+    public:
+        PcmResampler(
+            double inputRate,
+            double outputRate,
+            double cutoffFrequency,
+            unsigned int midpointDutyCycle,
+            unsigned int maxDutyCycle
+        );
+
+        unsigned int push(
+            unsigned int dutyCycle,
+            short* output,
+            unsigned int outputSize
+        );
+
+    private:
+        struct Biquad
+        {
+            double b0, b1, b2, a1, a2;
+            double z1, z2;
+        };
+
+        double inputRate;
+        double outputRate;
+        double midpointDutyCycle;
+        // the offset from the midpoint which makes a full scale PCM sample
+        double halfRange;
+        Biquad biquads[PCM_RESAMPLER_BIQUADS_COUNT];
+        // the last filtered input sample, and how many have been pushed
+        double previousValue;
+        unsigned long long inputsCount;
+        // how many output samples have been produced
+        unsigned long long outputsCount;
+
+        static void setupLowPass(
+            Biquad* biquad,
+            double sampleRate,
+            double cutoffFrequency,
+            double q
+        );
+        static double filter(Biquad* biquad, double value);
+        static short toPcm(double value);
+};
+
+#endif
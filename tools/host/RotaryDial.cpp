@@ -0,0 +1,58 @@
+#include "RotaryDial.h"
+
+#include <Arduino.h>
+
+RotaryDial::RotaryDial(
+    Simulator* simulator,
+    unsigned char rotaryMovePin,
+    unsigned char pulsePin
+):  simulator(simulator),
+    rotaryMovePin(rotaryMovePin),
+    pulsePin(pulsePin)
+{
+    this->simulator->setPin(this->rotaryMovePin, HIGH);
+    this->simulator->setPin(this->pulsePin, LOW);
+}
+
+/**
+ * @param digit The digit to dial, from 0 to 9 (0 being 10 pulses).
+ * @param windUpMs How long the rotary is moving before sending its first pulse.
+ * @param releaseDelayMs How long after the end of the last pulse the rotary
+ * reaches its rest position.
+ */
+DialTimeline RotaryDial::dial(
+    unsigned long long startCycle,
+    unsigned int digit,
+    double windUpMs,
+    double releaseDelayMs
+)
+{
+    const unsigned int pulsesCount = 0 == digit ? 10 : digit;
+    const unsigned long long breakCycles = this->simulator->msToCycles(DIAL_BREAK_MS);
+    const unsigned long long makeCycles = this->simulator->msToCycles(DIAL_MAKE_MS);
+
+    DialTimeline timeline;
+    timeline.offNormalCycle = startCycle;
+
+    this->simulator->schedulePin(startCycle, this->rotaryMovePin, LOW);
+
+    unsigned long long cycle = startCycle + this->simulator->msToCycles(windUpMs);
+    timeline.firstPulseCycle = cycle;
+
+    for (unsigned int i = 0; i < pulsesCount; i++) {
+        if (i > 0) {
+            cycle += makeCycles;
+        }
+
+        this->simulator->schedulePin(cycle, this->pulsePin, HIGH);
+        cycle += breakCycles;
+        this->simulator->schedulePin(cycle, this->pulsePin, LOW);
+    }
+
+    timeline.lastPulseEndCycle = cycle;
+    timeline.releaseCycle = cycle + this->simulator->msToCycles(releaseDelayMs);
+
+    this->simulator->schedulePin(timeline.releaseCycle, this->rotaryMovePin, HIGH);
+
+    return timeline;
+}
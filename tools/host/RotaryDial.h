@@ -0,0 +1,56 @@
+#ifndef S63_HOST_ROTARYDIAL_H
+#define S63_HOST_ROTARYDIAL_H
+
+#include "Simulator.h"
+
+// The S63 rotary sends pulses of 66ms, with a pause of 33ms between two pulses
+// (see RotaryListener::flushPulses()).
+#define DIAL_BREAK_MS 66
+#define DIAL_MAKE_MS 33
+
+/**
+ * When the events of a dialing happen, in µC cycles.
+ */
+struct DialTimeline
+{
+    // the rotary has left its rest position
+    unsigned long long offNormalCycle;
+    // the first pulse starts, i.e. the end of the wind up
+    unsigned long long firstPulseCycle;
+    // the pulse pin is back to its rest level after the last pulse
+    unsigned long long lastPulseEndCycle;
+    // the rotary is back to its rest position
+    unsigned long long releaseCycle;
+};
+
+/**
+ * Schedules on the Simulator the pins levels changes a S63 rotary produces
+ * when dialing a digit.
+ *
+ * At rest, the rotary move pin is HIGH (pulled up) and the pulse pin is LOW.
+ * The rotary move pin is LOW while the rotary is away from its rest position,
+ * and each pulse drives the pulse pin HIGH.
+ */
+class RotaryDial
+{
+    public:
+        RotaryDial(
+            Simulator* simulator,
+            unsigned char rotaryMovePin,
+            unsigned char pulsePin
+        );
+
+        DialTimeline dial(
+            unsigned long long startCycle,
+            unsigned int digit,
+            double windUpMs,
+            double releaseDelayMs
+        );
+
+    private:
+        Simulator* simulator;
+        unsigned char rotaryMovePin;
+        unsigned char pulsePin;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "ScriptInput.h"
+#include "UnixSocket.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+ScriptInput::ScriptInput()
+:   name(""),
+    file(false),
+    loops(1),
+    listeningFd(-1),
+    fd(-1),
+    exhausted(false),
+    nextLineIndex(0),
+    lineNumber(0),
+    playedCount(0)
+{}
+
+/**
+ * @param target '-' for stdin, 'unix:PATH' to listen on a UNIX socket, or the
+ * path of a script file.
+ * @param loops How many times a script file is played, 0 being forever.
+ * @return bool Whether the input is ready, `error` being filled otherwise.
+ */
+bool ScriptInput::open(const char* target, unsigned long loops, std::string* error)
+{
+    this->name = target;
+    this->loops = loops;
+
+    if (0 == strcmp(target, "-")) {
+        this->name = "stdin";
+        this->fd = STDIN_FILENO;
+
+        return true;
+    }
+
+    if (0 == strncmp(target, "unix:", 5)) {
+        this->listeningFd = listenUnixSocket(target + 5);
+
+        if (-1 == this->listeningFd) {
+            *error = (std::string) "Unable to listen on \"" + (target + 5) + "\" : " + strerror(errno) + ".";
+
+            return false;
+        }
+
+        return true;
+    }
+
+    this->file = true;
+
+    return this->readFile(target, error);
+}
+
+/**
+ * @return int The descriptor to poll for the next lines, -1 for a file.
+ */
+int ScriptInput::getPollFd() const
+{
+    return -1 != this->fd ? this->fd : this->listeningFd;
+}
+
+bool ScriptInput::isFile() const
+{
+    return this->file;
+}
+
+bool ScriptInput::isExhausted() const
+{
+    return this->exhausted;
+}
+
+/**
+ * @return unsigned long How many times a script file has been played through.
+ */
+unsigned long ScriptInput::getPlayedCount() const
+{
+    return this->playedCount;
+}
+
+/**
+ * @return std::string Where the last read line comes from, for the error
+ * messages.
+ */
+std::string ScriptInput::getPosition() const
+{
+    return this->name + ":" + std::to_string(this->lineNumber);
+}
+
+/**
+ * @return bool Whether a complete line has been read, without blocking.
+ */
+bool ScriptInput::readLine(std::string* line)
+{
+    if (this->isFile()) {
+        return this->readFileLine(line);
+    }
+
+    if (-1 == this->fd && -1 != this->listeningFd) {
+        this->fd = accept(this->listeningFd, NULL, NULL);
+
+        if (-1 == this->fd) {
+            return false;
+        }
+
+        setNonBlocking(this->fd);
+        this->pending.clear();
+        this->lineNumber = 0;
+    }
+
+    while (std::string::npos == this->pending.find('\n') && -1 != this->fd) {
+        struct pollfd pollFd = { this->fd, POLLIN, 0 };
+
+        // stdin is left blocking, a read only happens once it has some data
+        if (STDIN_FILENO == this->fd && 0 == poll(&pollFd, 1, 0)) {
+            break;
+        }
+
+        char chunk[SCRIPT_INPUT_LINE_MAX_LENGTH];
+        ssize_t count = read(this->fd, chunk, sizeof(chunk));
+
+        if (count > 0) {
+            this->pending.append(chunk, count);
+        } else if (0 == count || (EAGAIN != errno && EWOULDBLOCK != errno)) {
+            this->closeClient();
+        } else {
+            break;
+        }
+    }
+
+    size_t end = this->pending.find('\n');
+
+    if (std::string::npos == end) {
+        // stdin has been closed
+        this->exhausted = -1 == this->fd && -1 == this->listeningFd;
+
+        return false;
+    }
+
+    *line = this->pending.substr(0, end);
+    this->pending.erase(0, end + 1);
+    ++this->lineNumber;
+
+    return true;
+}
+
+bool ScriptInput::readFile(const char* path, std::string* error)
+{
+    FILE* file = fopen(path, "r");
+    char line[SCRIPT_INPUT_LINE_MAX_LENGTH];
+
+    if (nullptr == file) {
+        *error = (std::string) "Unable to read the script \"" + path + "\".";
+
+        return false;
+    }
+
+    while (nullptr != fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\n")] = '\0';
+        this->lines.push_back(line);
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+bool ScriptInput::readFileLine(std::string* line)
+{
+    if (this->nextLineIndex == this->lines.size()) {
+        ++this->playedCount;
+
+        if (this->lines.empty() || (0 != this->loops && this->playedCount >= this->loops)) {
+            this->exhausted = true;
+
+            return false;
+        }
+
+        this->nextLineIndex = 0;
+    }
+
+    this->lineNumber = this->nextLineIndex + 1;
+    *line = this->lines[this->nextLineIndex++];
+
+    return true;
+}
+
+void ScriptInput::closeClient()
+{
+    // the last line may not end with a new line
+    if (!this->pending.empty()) {
+        this->pending += '\n';
+    }
+
+    if (STDIN_FILENO != this->fd) {
+        close(this->fd);
+    }
+
+    this->fd = -1;
+}
@@ -0,0 +1,47 @@
+#ifndef S63_HOST_SCRIPTINPUT_H
+#define S63_HOST_SCRIPTINPUT_H
+
+#include <string>
+#include <vector>
+
+// the longest script line read from a file, new line included
+#define SCRIPT_INPUT_LINE_MAX_LENGTH 256
+
+/**
+ * The source of the dial script lines (see DialScript.h) : a file, played a
+ * given number of times, stdin, or the clients of a UNIX socket, one after the
+ * other. The lines are read without blocking : stdin being shared with the
+ * parent process, it is polled rather than switched to non blocking mode.
+ */
+class ScriptInput
+{
+    public:
+        ScriptInput();
+
+        bool open(const char* target, unsigned long loops, std::string* error);
+        int getPollFd() const;
+        bool isFile() const;
+        bool isExhausted() const;
+        unsigned long getPlayedCount() const;
+        std::string getPosition() const;
+        bool readLine(std::string* line);
+
+    private:
+        std::string name;
+        bool file;
+        unsigned long loops;
+        int listeningFd;
+        int fd;
+        bool exhausted;
+        std::string pending;
+        std::vector<std::string> lines;
+        unsigned int nextLineIndex;
+        unsigned int lineNumber;
+        unsigned long playedCount;
+
+        bool readFile(const char* path, std::string* error);
+        bool readFileLine(std::string* line);
+        void closeClient();
+};
+
+#endif
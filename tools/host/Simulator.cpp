@@ -0,0 +1,264 @@
+#include "Simulator.h"
+
+#include <Arduino.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+PORTMUX_t PORTMUX;
+PORT_t PORTB;
+TCA_t TCA0;
+TCB_t TCB0;
+TCB_t TCB1;
+TCB_t TCB2;
+
+Simulator* Simulator::instance = nullptr;
+
+Simulator* Simulator::build(unsigned long cyclesPerSecond)
+{
+    if (nullptr == instance) {
+        instance = new Simulator(cyclesPerSecond);
+    }
+
+    return instance;
+}
+
+Simulator* Simulator::getInstance()
+{
+    return instance;
+}
+
+Simulator::Simulator(unsigned long cyclesPerSecond)
+:   cyclesPerSecond(cyclesPerSecond),
+    cycle(0),
+    sampleCallback(nullptr),
+    sampleCallbackContext(nullptr)
+{
+    // the input pins are pulled up by default
+    for (unsigned int i = 0; i < SIMULATOR_PINS_COUNT; i++) {
+        this->pins[i] = HIGH;
+    }
+
+    this->tca0 = { TIMER_TCA, &TCA0, TCA0_OVF_vect, false, 0 };
+    this->tcb1 = { TIMER_TCB, &TCB1, TCB1_INT_vect, false, 0 };
+    this->tcb2 = { TIMER_TCB, &TCB2, TCB2_INT_vect, false, 0 };
+
+    this->initArduinoCore();
+}
+
+/**
+ * Configure the timers as the init() function of the Arduino megaavr core does
+ * (see cores/arduino/wiring.c) : TCA0 in split mode counting at µC speed / 64
+ * for analogWrite(), and the TCB timers in 8bit PWM mode counting on the TCA0
+ * clock.
+ */
+void Simulator::initArduinoCore()
+{
+    TCA0.SINGLE.CTRLD = TCA_SINGLE_SPLITM_bm;
+    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV64_gc | TCA_SINGLE_ENABLE_bm;
+
+    TCB_t* timers[] = { &TCB0, &TCB1, &TCB2 };
+
+    for (TCB_t* timer : timers) {
+        timer->CTRLB = TCB_CNTMODE_PWM8_gc;
+        timer->CCMPL = 0xFE;
+        timer->CCMPH = 0x80;
+        timer->CTRLA = TCB_CLKSEL_CLKTCA_gc | TCB_ENABLE_bm;
+    }
+}
+
+unsigned long long Simulator::now() const
+{
+    return this->cycle;
+}
+
+unsigned long long Simulator::msToCycles(double ms) const
+{
+    return (unsigned long long) (ms * this->cyclesPerSecond / 1000.0);
+}
+
+double Simulator::cyclesToUs(unsigned long long cycles) const
+{
+    return cycles * 1000000.0 / this->cyclesPerSecond;
+}
+
+void Simulator::setPin(unsigned char pin, unsigned char level)
+{
+    this->pins[pin] = level;
+}
+
+unsigned char Simulator::readPin(unsigned char pin) const
+{
+    return this->pins[pin];
+}
+
+void Simulator::schedulePin(
+    unsigned long long cycle,
+    unsigned char pin,
+    unsigned char level
+)
+{
+    this->pinEvents.insert(std::make_pair(cycle, std::make_pair(pin, level)));
+}
+
+void Simulator::onSample(SampleCallback callback, void* context)
+{
+    this->sampleCallback = callback;
+    this->sampleCallbackContext = context;
+}
+
+void Simulator::runUntil(unsigned long long cycle)
+{
+    unsigned long long next;
+
+    while ((next = this->getNextEventCycle()) <= cycle) {
+        this->runEventsAt(next);
+    }
+
+    this->cycle = cycle;
+}
+
+/**
+ * Run the events of the next cycle having any.
+ */
+void Simulator::step()
+{
+    this->runEventsAt(this->getNextEventCycle());
+}
+
+/**
+ * @return unsigned long long The next cycle at which a pin changes or an ISR
+ * is triggered, or the maximum cycle when there is none.
+ */
+unsigned long long Simulator::getNextEventCycle()
+{
+    this->syncTimer(&this->tca0);
+    this->syncTimer(&this->tcb1);
+    this->syncTimer(&this->tcb2);
+
+    unsigned long long next = ~0ULL;
+
+    if (!this->pinEvents.empty()) {
+        next = this->pinEvents.begin()->first;
+    }
+
+    const TimerState* timers[] = { &this->tca0, &this->tcb1, &this->tcb2 };
+
+    for (const TimerState* timer : timers) {
+        if (timer->running && timer->nextFireCycle < next) {
+            next = timer->nextFireCycle;
+        }
+    }
+
+    return next;
+}
+
+void Simulator::runEventsAt(unsigned long long cycle)
+{
+    this->cycle = cycle;
+
+    while (!this->pinEvents.empty() && this->pinEvents.begin()->first == cycle) {
+        std::pair<unsigned char, unsigned char> event = this->pinEvents.begin()->second;
+        this->setPin(event.first, event.second);
+        this->pinEvents.erase(this->pinEvents.begin());
+    }
+
+    if (this->tca0.running && this->tca0.nextFireCycle == cycle) {
+        this->fireTimer(&this->tca0);
+
+        if (nullptr != this->sampleCallback) {
+            this->sampleCallback(cycle, TCA0.SINGLE.CMP0BUF, this->sampleCallbackContext);
+        }
+    }
+
+    if (this->tcb1.running && this->tcb1.nextFireCycle == cycle) {
+        this->fireTimer(&this->tcb1);
+
+        if (nullptr != this->sampleCallback) {
+            this->sampleCallback(cycle, TCB1.CCMPH, this->sampleCallbackContext);
+        }
+    }
+
+    if (this->tcb2.running && this->tcb2.nextFireCycle == cycle) {
+        this->fireTimer(&this->tcb2);
+    }
+}
+
+/**
+ * @return unsigned long long The prescaler of the TCA0 clock.
+ */
+unsigned long long Simulator::getTcaDivider() const
+{
+    static const unsigned int dividers[] = { 1, 2, 4, 8, 16, 64, 256, 1024 };
+
+    return dividers[(TCA0.SINGLE.CTRLA & TCA_SINGLE_CLKSEL_gm) >> 1];
+}
+
+/**
+ * @return unsigned long long The amount of µC cycles between two interrupts of
+ * the given timer, according to its current configuration.
+ */
+unsigned long long Simulator::getTimerPeriod(const TimerState* timer) const
+{
+    if (TIMER_TCA == timer->type) {
+        // single slope mode, the counter counts from 0 up to PER
+        return this->getTcaDivider() * ((unsigned long long) TCA0.SINGLE.PER + 1);
+    }
+
+    const TCB_t* tcb = (const TCB_t*) timer->registers;
+    unsigned long long divider = 1;
+
+    switch (tcb->CTRLA & TCB_CLKSEL_gm) {
+        case TCB_CLKSEL_CLKDIV2_gc:
+            divider = 2;
+            break;
+
+        case TCB_CLKSEL_CLKTCA_gc:
+            divider = this->getTcaDivider();
+            break;
+    }
+
+    // In 8bit PWM mode, the counter counts up to CCMPL. In the other modes it
+    // counts up to the full 16bit CCMP value. In both cases it starts from 0.
+    if (TCB_CNTMODE_PWM8_gc == (tcb->CTRLB & TCB_CNTMODE_gm)) {
+        return divider * ((unsigned long long) tcb->CCMPL + 1);
+    }
+
+    return divider * ((unsigned long long) tcb->CCMP + 1);
+}
+
+bool Simulator::isTimerEnabled(const TimerState* timer) const
+{
+    if (nullptr == timer->isr) {
+        return false;
+    }
+
+    if (TIMER_TCA == timer->type) {
+        return (TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm)
+            && (TCA0.SINGLE.INTCTRL & TCA_SINGLE_OVF_bm)
+            && !(TCA0.SINGLE.CTRLD & TCA_SINGLE_SPLITM_bm)
+        ;
+    }
+
+    const TCB_t* tcb = (const TCB_t*) timer->registers;
+
+    return (tcb->CTRLA & TCB_ENABLE_bm) && (tcb->INTCTRL & TCB_CAPT_bm);
+}
+
+void Simulator::syncTimer(TimerState* timer)
+{
+    bool enabled = this->isTimerEnabled(timer);
+
+    if (enabled && !timer->running) {
+        timer->nextFireCycle = this->cycle + this->getTimerPeriod(timer);
+    }
+
+    timer->running = enabled;
+}
+
+void Simulator::fireTimer(TimerState* timer)
+{
+    timer->isr();
+
+    // the counter restarts from 0 once it has reached its TOP value
+    timer->nextFireCycle += this->getTimerPeriod(timer);
+}
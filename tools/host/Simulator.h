@@ -0,0 +1,92 @@
+#ifndef S63_HOST_SIMULATOR_H
+#define S63_HOST_SIMULATOR_H
+
+#include <avr/io.h>
+#include <map>
+#include <utility>
+
+#define SIMULATOR_PINS_COUNT 32
+
+/**
+ * Called after each ISR of the timer generating the PWM (TCB1 or TCA0), with
+ * the virtual clock cycle at which the ISR has been triggered and the duty
+ * cycle the firmware has left on the PWM output.
+ */
+typedef void (*SampleCallback)(
+    unsigned long long cycle,
+    unsigned int dutyCycle,
+    void* context
+);
+
+/**
+ * Runs the firmware on a virtual clock, counting µC cycles.
+ *
+ * The timers are first configured as the Arduino core leaves them before
+ * calling `setup()`. They are then triggered according to how the firmware
+ * has configured them (enable bit, clock source, counter mode and period), and
+ * the input pins levels are changed by scheduled events. As on the chip, the
+ * ISRs are run by vector priority (TCA0, TCB1 then TCB2) when due on the same
+ * cycle, and pins changes are applied before the ISRs of the same cycle get
+ * to read them.
+ *
+ * ISRs are considered instantaneous : they never delay each other.
+ */
+class Simulator
+{
+    public:
+        static Simulator* build(unsigned long cyclesPerSecond);
+        static Simulator* getInstance();
+
+        unsigned long long now() const;
+        unsigned long long msToCycles(double ms) const;
+        double cyclesToUs(unsigned long long cycles) const;
+
+        void setPin(unsigned char pin, unsigned char level);
+        unsigned char readPin(unsigned char pin) const;
+        void schedulePin(
+            unsigned long long cycle,
+            unsigned char pin,
+            unsigned char level
+        );
+
+        void onSample(SampleCallback callback, void* context);
+        void runUntil(unsigned long long cycle);
+        void step();
+
+    private:
+        enum TimerType { TIMER_TCA, TIMER_TCB };
+
+        struct TimerState
+        {
+            TimerType type;
+            volatile void* registers;
+            void (*isr)(void);
+            bool running;
+            unsigned long long nextFireCycle;
+        };
+
+        Simulator(unsigned long cyclesPerSecond);
+
+        static Simulator* instance;
+
+        unsigned long cyclesPerSecond;
+        unsigned long long cycle;
+        unsigned char pins[SIMULATOR_PINS_COUNT];
+        std::multimap<unsigned long long, std::pair<unsigned char, unsigned char> > pinEvents;
+        TimerState tca0;
+        TimerState tcb1;
+        TimerState tcb2;
+        SampleCallback sampleCallback;
+        void* sampleCallbackContext;
+
+        void initArduinoCore();
+        unsigned long long getNextEventCycle();
+        void runEventsAt(unsigned long long cycle);
+        unsigned long long getTcaDivider() const;
+        unsigned long long getTimerPeriod(const TimerState* timer) const;
+        bool isTimerEnabled(const TimerState* timer) const;
+        void syncTimer(TimerState* timer);
+        void fireTimer(TimerState* timer);
+};
+
+#endif
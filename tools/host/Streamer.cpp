@@ -0,0 +1,392 @@
+#include "Streamer.h"
+#include "Variables.h"
+#include "RotaryListener.h"
+#include "DtmfGenerator.h"
+#include "SpeedDial.h"
+
+#include <algorithm>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+
+/**
+ * @param rate The PCM sample rate, in Hz.
+ * @param cutoff The low pass filter cutoff, in Hz.
+ * @param bufferMs The max amount of audio held for a slow consumer, in ms.
+ * @param reportMs How often the stream latency is reported, in ms, 0 to
+ * disable.
+ */
+Streamer::Streamer(
+    Simulator* simulator,
+    DialedDigit* dialedDigit,
+    PcmOutput* output,
+    ScriptInput* input,
+    unsigned long rate,
+    unsigned long cutoff,
+    unsigned long bufferMs,
+    unsigned long reportMs
+):  simulator(simulator),
+    output(output),
+    input(input),
+    rate(rate),
+    reportMs(reportMs),
+    rotaryDial(simulator, ROTARY_MOVE_PIN, PULSE_PIN),
+    dialScript(simulator, &rotaryDial, DTMF_DURATION_MS),
+    resampler(
+        DtmfGenerator::PERIOD_FREQUENCY,
+        rate,
+        cutoff,
+        DtmfGenerator::PWM_MIDPOINT_VALUE,
+        DtmfGenerator::PWM_MAX_VALUE
+    ),
+    buffer(bufferMs * rate / 1000 + 1),
+    wallStartSeconds(0),
+    failed(false),
+    passCursorCycle(0),
+    playedCount(0),
+    quietSamplesCount(0),
+    quietSinceCycle(0),
+    tonesCount(0),
+    missedCount(0),
+    wrongCount(0),
+    maxToneLatencyMs(0),
+    maxStreamedToneLatencyMs(0)
+{
+    memset(&this->stats, 0, sizeof(this->stats));
+
+    this->passCursorCycle = this->dialScript.getCursorCycle();
+    this->dialScript.onDial(onDial, this);
+    dialedDigit->onPush(onPush, this);
+    this->simulator->onSample(onSample, this);
+}
+
+/**
+ * Stream until the script is over and its tones have been streamed, the
+ * consumer has gone away, or `stopping` is set (e.g. by a signal handler).
+ *
+ * @return bool Whether all the queued digits have produced a tone, and each
+ * dialing has queued its own digit or a speed dial.
+ */
+bool Streamer::run(volatile sig_atomic_t* stopping)
+{
+    double nextReportSeconds = this->reportMs / 1000.0;
+
+    this->wallStartSeconds = getWallSeconds();
+
+    while (!*stopping && !this->output->isGone() && !this->failed && !this->isOver()) {
+        this->feedScript();
+
+        double elapsedSeconds = getWallSeconds() - this->wallStartSeconds;
+
+        this->simulator->runUntil(elapsedSeconds * XTAL);
+        // as the firmware main loop does
+        RotaryListener::getInstance()->getSpeedDial()->storeIfPending();
+        this->flush();
+
+        if (0 != this->reportMs && elapsedSeconds >= nextReportSeconds) {
+            this->report(elapsedSeconds);
+            nextReportSeconds += this->reportMs / 1000.0;
+        }
+
+        struct pollfd pollFd = { this->input->getPollFd(), POLLIN, 0 };
+        poll(&pollFd, -1 == pollFd.fd ? 0 : 1, STREAMER_TICK_MS);
+    }
+
+    this->retireDials(this->simulator->now(), true);
+    this->printSummary();
+
+    return !this->failed && 0 == this->missedCount && 0 == this->wrongCount;
+}
+
+void Streamer::onDial(unsigned int digit, const DialTimeline& timeline, void* context)
+{
+    Streamer* streamer = (Streamer*) context;
+    DialEvent dial = { digit, timeline.releaseCycle, false };
+
+    streamer->dials.push_back(dial);
+}
+
+/**
+ * Expect a tone for each digit the firmware queues, answering the last
+ * released dialing.
+ */
+void Streamer::onPush(unsigned int digit, bool burst, void* context)
+{
+    Streamer* streamer = (Streamer*) context;
+    const unsigned long long now = streamer->simulator->now();
+
+    streamer->retireDials(now, false);
+
+    if (streamer->dials.empty() || streamer->dials.front().releaseCycle > now) {
+        ToneEvent tone = { digit, burst, false, now, now, 0 };
+
+        ++streamer->wrongCount;
+        streamer->awaitedTones.push_back(tone);
+
+        fprintf(stderr, "digit %u : WRONG, queued before any rotary release\n", digit);
+
+        return;
+    }
+
+    DialEvent* dial = &streamer->dials.front();
+    ToneEvent tone = { digit, burst, !dial->answered, dial->releaseCycle, now, 0 };
+
+    // a speed dial queues the digits of its slot, an empty slot its own
+    if (!burst && digit != dial->digit) {
+        ++streamer->wrongCount;
+
+        fprintf(stderr, "digit %u : WRONG, queued as %u\n", dial->digit, digit);
+    }
+
+    dial->answered = true;
+    streamer->awaitedTones.push_back(tone);
+}
+
+/**
+ * Forget the dialings released by `cycle` but the last one, or all of them
+ * once the stream is over, reporting the ones which have queued no digit (i.e.
+ * the speed dial store gestures and recorded digits).
+ */
+void Streamer::retireDials(unsigned long long cycle, bool over)
+{
+    while (!this->dials.empty() && this->dials.front().releaseCycle <= cycle) {
+        if (!over && (this->dials.size() < 2 || this->dials[1].releaseCycle > cycle)) {
+            return;
+        }
+
+        if (!this->dials.front().answered) {
+            fprintf(stderr, "digit %u : no tone queued\n", this->dials.front().digit);
+        }
+
+        this->dials.pop_front();
+    }
+}
+
+void Streamer::onSample(unsigned long long cycle, unsigned int dutyCycle, void* context)
+{
+    Streamer* streamer = (Streamer*) context;
+    short samples[STREAMER_MAX_SAMPLES_PER_PUSH];
+    unsigned int count = streamer->resampler.push(dutyCycle, samples, STREAMER_MAX_SAMPLES_PER_PUSH);
+
+    for (unsigned int i = 0; i < count; i++) {
+        streamer->buffer.push(samples[i]);
+    }
+
+    streamer->probeTone(cycle, dutyCycle);
+}
+
+void Streamer::probeTone(unsigned long long cycle, unsigned int dutyCycle)
+{
+    if (DtmfGenerator::PWM_MIDPOINT_VALUE == dutyCycle) {
+        if (0 == this->quietSamplesCount++) {
+            this->quietSinceCycle = cycle;
+        }
+
+        this->expireAwaitedTone(cycle);
+
+        return;
+    }
+
+    const bool onset = this->quietSamplesCount
+        >= DtmfGenerator::PERIOD_FREQUENCY * STREAMER_TONE_QUIET_MS / 1000;
+
+    this->quietSamplesCount = 0;
+
+    if (!onset) {
+        return;
+    }
+
+    // the tones are played in the queue order
+    if (this->awaitedTones.empty()) {
+        fprintf(stderr, "tone without any queued digit\n");
+
+        return;
+    }
+
+    ToneEvent tone = this->awaitedTones.front();
+    tone.onsetCycle = cycle;
+
+    this->producedTones.push_back(tone);
+    this->awaitedTones.pop_front();
+}
+
+/**
+ * A queued digit is missed when the output stays quiet for too long while it
+ * is the next one to be played.
+ */
+void Streamer::expireAwaitedTone(unsigned long long cycle)
+{
+    if (this->awaitedTones.empty()) {
+        return;
+    }
+
+    ToneEvent tone = this->awaitedTones.front();
+    const unsigned long long waitingSinceCycle = std::max(tone.queuedCycle, this->quietSinceCycle);
+
+    if (cycle - waitingSinceCycle > this->simulator->msToCycles(STREAMER_TONE_TIMEOUT_MS)) {
+        ++this->missedCount;
+        this->awaitedTones.pop_front();
+
+        fprintf(stderr, "%s %u : MISSED, no tone %d ms after being queued\n",
+            tone.speedDial ? "speed dial digit" : "digit", tone.digit, STREAMER_TONE_TIMEOUT_MS
+        );
+    }
+}
+
+/**
+ * Schedule the script lines up to STREAMER_SCRIPT_HORIZON_MS ahead of the
+ * virtual clock.
+ */
+void Streamer::feedScript()
+{
+    std::string line, error;
+    const unsigned long long horizonCycles = this->simulator->msToCycles(STREAMER_SCRIPT_HORIZON_MS);
+
+    while (this->dialScript.getCursorCycle() < this->simulator->now() + horizonCycles
+        && this->input->readLine(&line)
+    ) {
+        if (this->input->getPlayedCount() != this->playedCount) {
+            // a looped pass scheduling nothing would never move the cursor
+            if (this->dialScript.getCursorCycle() == this->passCursorCycle) {
+                fprintf(stderr, "%s : the script has no dial nor wait command, it can't be looped\n",
+                    this->input->getPosition().c_str()
+                );
+                this->failed = true;
+
+                return;
+            }
+
+            this->playedCount = this->input->getPlayedCount();
+            this->passCursorCycle = this->dialScript.getCursorCycle();
+        }
+
+        if (this->dialScript.execute(line.c_str(), &error)) {
+            continue;
+        }
+
+        fprintf(stderr, "%s : %s\n", this->input->getPosition().c_str(), error.c_str());
+
+        // a script file is expected to be valid, unlike live inputs
+        if (this->input->isFile()) {
+            this->failed = true;
+
+            return;
+        }
+    }
+}
+
+void Streamer::flush()
+{
+    const double nowSeconds = getWallSeconds() - this->wallStartSeconds;
+    unsigned int count;
+
+    while (this->buffer.size() > 0) {
+        const short* samples = this->buffer.peek(&count);
+
+        if (!this->output->isConnected()) {
+            this->output->write(samples, count);
+            this->stats.discardedCount += count;
+            this->buffer.consume(count);
+
+            continue;
+        }
+
+        // the oldest sample of the write is the one waiting the most
+        double latencyMs = (nowSeconds - (double) this->buffer.getConsumedCount() / this->rate) * 1000;
+        unsigned int written = this->output->write(samples, count);
+
+        if (0 == written) {
+            break;
+        }
+
+        this->buffer.consume(written);
+
+        ++this->stats.writesCount;
+        this->stats.writtenCount += written;
+        this->stats.totalLatencyMs += latencyMs;
+        this->stats.maxLatencyMs = std::max(this->stats.maxLatencyMs, latencyMs);
+    }
+
+    this->stats.maxBufferedMs = std::max(
+        this->stats.maxBufferedMs,
+        this->buffer.size() * 1000.0 / this->rate
+    );
+
+    // the tones whose first sample has left the buffer
+    while (!this->producedTones.empty()
+        && this->buffer.getConsumedCount() > this->producedTones.front().onsetCycle * this->rate / XTAL
+    ) {
+        ToneEvent tone = this->producedTones.front();
+        double releaseSeconds = (double) tone.releaseCycle / XTAL;
+        double toneLatencyMs = this->simulator->cyclesToUs(tone.onsetCycle - tone.releaseCycle) / 1000;
+        double streamedLatencyMs = (nowSeconds - releaseSeconds) * 1000;
+
+        ++this->tonesCount;
+        this->producedTones.pop_front();
+
+        // the latency of the tones answering a dialing
+        if (tone.first) {
+            this->maxToneLatencyMs = std::max(this->maxToneLatencyMs, toneLatencyMs);
+            this->maxStreamedToneLatencyMs = std::max(this->maxStreamedToneLatencyMs, streamedLatencyMs);
+        }
+
+        fprintf(stderr, "%s %u : %s %.1f ms after the rotary release, streamed after %.1f ms\n",
+            tone.speedDial ? "speed dial digit" : "digit",
+            tone.digit,
+            tone.first ? "tone" : "next tone",
+            toneLatencyMs,
+            streamedLatencyMs
+        );
+    }
+}
+
+bool Streamer::isOver() const
+{
+    return this->input->isExhausted()
+        && this->awaitedTones.empty()
+        && this->producedTones.empty()
+        && this->simulator->now() > this->dialScript.getCursorCycle()
+            + this->simulator->msToCycles(STREAMER_TAIL_MS)
+    ;
+}
+
+void Streamer::report(double elapsedSeconds)
+{
+    const unsigned long long droppedCount = this->buffer.getDroppedCount();
+
+    fprintf(stderr, "stream %8.1f s : %llu samples, latency avg %.1f ms max %.1f ms, buffered max %.1f ms, dropped %llu, discarded %llu\n",
+        elapsedSeconds,
+        this->stats.writtenCount,
+        0 == this->stats.writesCount ? 0 : this->stats.totalLatencyMs / this->stats.writesCount,
+        this->stats.maxLatencyMs,
+        this->stats.maxBufferedMs,
+        droppedCount - this->stats.droppedCount,
+        this->stats.discardedCount
+    );
+
+    memset(&this->stats, 0, sizeof(this->stats));
+    this->stats.droppedCount = droppedCount;
+}
+
+void Streamer::printSummary() const
+{
+    fprintf(stderr, "\n%lu tones streamed, %lu missed, %lu wrong, %llu samples dropped.\n",
+        this->tonesCount, this->missedCount, this->wrongCount, this->buffer.getDroppedCount()
+    );
+
+    if (this->tonesCount > 0) {
+        fprintf(stderr, "Max latency from the rotary release : tone %.1f ms, streamed %.1f ms.\n",
+            this->maxToneLatencyMs, this->maxStreamedToneLatencyMs
+        );
+    }
+}
+
+double Streamer::getWallSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
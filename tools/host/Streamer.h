@@ -0,0 +1,144 @@
+#ifndef S63_HOST_STREAMER_H
+#define S63_HOST_STREAMER_H
+
+#include "DialedDigit.h"
+#include "Simulator.h"
+#include "RotaryDial.h"
+#include "DialScript.h"
+#include "PcmResampler.h"
+#include "PcmBuffer.h"
+#include "PcmOutput.h"
+#include "ScriptInput.h"
+
+#include <deque>
+#include <signal.h>
+
+#ifndef ENABLE_DIALED_DIGIT_HOOK
+#error "The streamer follows the queued digits, ENABLE_DIALED_DIGIT_HOOK must be defined."
+#endif
+
+// how often the virtual clock catches up with the wall clock, in ms
+#define STREAMER_TICK_MS 2
+// how far ahead of the virtual clock the script commands are scheduled, in ms
+#define STREAMER_SCRIPT_HORIZON_MS 1000
+// how long the output may stay at its rest level while a digit is queued,
+// before considering the digit as missed, in ms
+#define STREAMER_TONE_TIMEOUT_MS 500
+// how long the output must stay at its rest level between two tones, in ms
+#define STREAMER_TONE_QUIET_MS 1
+// how long the stream keeps running once the script is over, in ms
+#define STREAMER_TAIL_MS 500
+// the most PCM samples a PWM sample can be resampled into
+#define STREAMER_MAX_SAMPLES_PER_PUSH 8
+
+/**
+ * Runs the simulation paced on the wall clock, and connects it to the script
+ * and to the stream : the DTMF output is resampled as PCM audio, and each tone
+ * is reported with its latency from the rotary release, and the stream with
+ * its buffering latency.
+ *
+ * The tones are expected from the digits the firmware queues (see
+ * ENABLE_DIALED_DIGIT_HOOK), each one answering the last released dialing :
+ * the speed dial gestures are left to the firmware, a dialing queueing no
+ * digit being only reported.
+ */
+class Streamer
+{
+    public:
+        Streamer(
+            Simulator* simulator,
+            DialedDigit* dialedDigit,
+            PcmOutput* output,
+            ScriptInput* input,
+            unsigned long rate,
+            unsigned long cutoff,
+            unsigned long bufferMs,
+            unsigned long reportMs
+        );
+
+        bool run(volatile sig_atomic_t* stopping);
+
+    private:
+        struct ToneEvent
+        {
+            // the queued digit
+            unsigned int digit;
+            // whether it is played at the speed dial burst timings
+            bool speedDial;
+            // whether it is the tone answering the dialing, rather than one of
+            // the next tones of a speed dial burst
+            bool first;
+            unsigned long long releaseCycle;
+            unsigned long long queuedCycle;
+            // the first sample leaving the rest level, 0 while not produced yet
+            unsigned long long onsetCycle;
+        };
+
+        struct DialEvent
+        {
+            unsigned int digit;
+            unsigned long long releaseCycle;
+            // whether a digit has been queued since the release
+            bool answered;
+        };
+
+        struct StreamStats
+        {
+            unsigned long long writtenCount;
+            // how many samples the buffer had dropped when the period started
+            unsigned long long droppedCount;
+            // the samples produced while no stream client was connected
+            unsigned long long discardedCount;
+            unsigned long writesCount;
+            double totalLatencyMs;
+            double maxLatencyMs;
+            double maxBufferedMs;
+        };
+
+        Simulator* simulator;
+        PcmOutput* output;
+        ScriptInput* input;
+        unsigned long rate;
+        unsigned long reportMs;
+        RotaryDial rotaryDial;
+        DialScript dialScript;
+        PcmResampler resampler;
+        PcmBuffer buffer;
+        double wallStartSeconds;
+        // an invalid script file has been read
+        bool failed;
+        // where the virtual clock cursor was when the script file pass started
+        unsigned long long passCursorCycle;
+        unsigned long playedCount;
+        // the scheduled dialings, the front one being the last released once
+        // the virtual clock has reached it
+        std::deque<DialEvent> dials;
+        // the queued digits waiting for their tone, then for the tone to be
+        // streamed
+        std::deque<ToneEvent> awaitedTones;
+        std::deque<ToneEvent> producedTones;
+        unsigned long quietSamplesCount;
+        unsigned long long quietSinceCycle;
+        StreamStats stats;
+        unsigned long tonesCount;
+        unsigned long missedCount;
+        // the dialings queueing another digit than the dialed one
+        unsigned long wrongCount;
+        double maxToneLatencyMs;
+        double maxStreamedToneLatencyMs;
+
+        static void onDial(unsigned int digit, const DialTimeline& timeline, void* context);
+        static void onPush(unsigned int digit, bool burst, void* context);
+        static void onSample(unsigned long long cycle, unsigned int dutyCycle, void* context);
+        static double getWallSeconds();
+        void probeTone(unsigned long long cycle, unsigned int dutyCycle);
+        void expireAwaitedTone(unsigned long long cycle);
+        void retireDials(unsigned long long cycle, bool over);
+        void feedScript();
+        void flush();
+        bool isOver() const;
+        void report(double elapsedSeconds);
+        void printSummary() const;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "UnixSocket.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @return int The non blocking listening socket bound to `path`, -1 on
+ * failure (errno being set).
+ */
+int listenUnixSocket(const char* path)
+{
+    struct sockaddr_un address;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (-1 == fd) {
+        return -1;
+    }
+
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    if (-1 == bind(fd, (struct sockaddr*) &address, sizeof(address)) || -1 == listen(fd, 1)) {
+        int error = errno;
+
+        close(fd);
+        errno = error;
+
+        return -1;
+    }
+
+    setNonBlocking(fd);
+
+    return fd;
+}
+
+void setNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
@@ -0,0 +1,7 @@
+#ifndef S63_HOST_UNIXSOCKET_H
+#define S63_HOST_UNIXSOCKET_H
+
+int listenUnixSocket(const char* path);
+void setNonBlocking(int fd);
+
+#endif
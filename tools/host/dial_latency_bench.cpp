@@ -0,0 +1,520 @@
+/**
+ * Measures the delay between the end of a dialing and the first sample of the
+ * corresponding DTMF tone, by running the firmware on a virtual clock and
+ * driving its input pins with scripted S63 dialings.
+ *
+ * A number stored in a speed dial slot is then played, and the whole call
+ * setup is measured : from the rotary leaving its rest position to the end of
+ * the last tone.
+ *
+ * The run is fully deterministic for a given seed and trials count, so its
+ * results can be compared across commits : when a baseline file is given, the
+ * program fails if any latency is greater than the recorded one.
+ *
+ * $ make bench
+ * $ build/host/dial_latency_bench --help
+ */
+
+#include "Variables.h"
+#include "DialedDigit.h"
+#include "RotaryListener.h"
+#include "DtmfGenerator.h"
+#include "SpeedDial.h"
+#include "Simulator.h"
+#include "RotaryDial.h"
+
+#include <EEPROM.h>
+
+#include <algorithm>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define PROGRAM_NAME "dial_latency_bench"
+#define PROGRAM_VERSION "0.1.0"
+
+#define DEFAULT_TRIALS 1000
+#define DEFAULT_SEED 1
+
+// how long to wait for the tone after the rotary has been released, before
+// considering the digit as missed
+#define TONE_TIMEOUT_MS 500
+// the quiet time between two dialings
+#define DIALINGS_GAP_MS 100
+// how long the user winds the rotary up before releasing it
+#define WIND_UP_MIN_MS 150
+#define WIND_UP_MAX_MS 350
+// how long after its last pulse the rotary reaches its rest position
+#define RELEASE_DELAY_MIN_MS 10
+#define RELEASE_DELAY_MAX_MS 60
+
+// the speed dial slot played, and the number it holds
+#define SPEED_DIAL_SLOT 1
+#define SPEED_DIAL_NUMBER "0612345678"
+// how long to wait for the end of the speed dial burst
+#define SPEED_DIAL_TIMEOUT_MS 5000
+
+#define HISTOGRAM_BINS 20
+#define HISTOGRAM_BAR_WIDTH 50
+
+#define METRICS_COUNT 7
+
+static unsigned long trials, seed;
+static const char* baselinePath = nullptr;
+static bool updateBaseline = false;
+
+static struct option const longopts[] =
+{
+    {"trials", required_argument, NULL, 'n'},
+    {"seed", required_argument, NULL, 's'},
+    {"baseline", required_argument, NULL, 'b'},
+    {"update-baseline", no_argument, NULL, 'u'},
+    {"help", no_argument, NULL, 'h'},
+    {"version", no_argument, NULL, 'v'},
+    {NULL, 0, NULL, 0}
+};
+
+struct Percentiles
+{
+    unsigned long long p50;
+    unsigned long long p99;
+    unsigned long long max;
+};
+
+struct ToneProbe
+{
+    unsigned long long trialStartCycle;
+    unsigned long long firstToneCycle;
+    unsigned long long lastToneCycle;
+    // the duty cycle of the output while no tone is generated
+    unsigned int restDutyCycle;
+};
+
+void usage(int status)
+{
+    if (status != EXIT_SUCCESS) {
+        fprintf(stderr, "Try '%s --help' for more information.\n", PROGRAM_NAME);
+    } else {
+        printf("\
+Usage: %s [OPTION]...\n\
+", PROGRAM_NAME);
+        printf("\
+\n\
+Dials random digits on a simulated S63 rotary and reports the latency\n\
+distributions (p50, p99, max) from the end of the last pulse and from the\n\
+rotary release, to the first DTMF output sample leaving the rest level. Then\n\
+plays a 10 digits speed dial, and reports how long it takes from the rotary\n\
+leaving its rest position to the end of the last tone.\n\
+");
+
+        printf("\
+\n\
+Run options :\n\
+    -n, --trials           The amount of digits to dial. Defaults to %d.\n\
+    -s, --seed             The seed of the random dialings. Defaults to %d.\n\
+", DEFAULT_TRIALS, DEFAULT_SEED);
+        printf("\
+\n\
+Regression gate options :\n\
+    -b, --baseline         The file holding the reference latencies. The\n\
+                           program exits with a failure status if any\n\
+                           measured latency is greater than its reference.\n\
+    -u, --update-baseline  Write the measured latencies to the baseline file\n\
+                           instead of comparing them.\n\
+");
+
+        printf("\
+\n\
+Common options :\n\
+    --help                 Display this help and exit.\n\
+    --version              Output version information and exit.\n\
+\n\
+");
+    }
+
+    exit(status);
+}
+
+/**
+ * xorshift64, so that the dialings are the same whatever the host libc is.
+ */
+unsigned long long nextRandom(unsigned long long* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+unsigned long long randomBetween(
+    unsigned long long* state,
+    unsigned long long min,
+    unsigned long long max
+)
+{
+    return min + nextRandom(state) % (max - min + 1);
+}
+
+void probeTone(unsigned long long cycle, unsigned int dutyCycle, void* context)
+{
+    ToneProbe* probe = (ToneProbe*) context;
+
+    if (cycle < probe->trialStartCycle) {
+        probe->restDutyCycle = dutyCycle;
+
+        return;
+    }
+
+    if (probe->restDutyCycle == dutyCycle) {
+        return;
+    }
+
+    if (0 == probe->firstToneCycle) {
+        probe->firstToneCycle = cycle;
+    }
+
+    probe->lastToneCycle = cycle;
+}
+
+Percentiles computePercentiles(std::vector<unsigned long long> latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+
+    // nearest rank method
+    Percentiles percentiles;
+    percentiles.p50 = latencies[(latencies.size() * 50 + 99) / 100 - 1];
+    percentiles.p99 = latencies[(latencies.size() * 99 + 99) / 100 - 1];
+    percentiles.max = latencies.back();
+
+    return percentiles;
+}
+
+void printHistogram(
+    Simulator* simulator,
+    const char* title,
+    const std::vector<unsigned long long>& latencies
+)
+{
+    const unsigned long long highestLatency = *std::max_element(latencies.begin(), latencies.end());
+    const unsigned long long binCycles = highestLatency / HISTOGRAM_BINS + 1;
+    unsigned long bins[HISTOGRAM_BINS] = { 0 };
+    unsigned long highest = 0;
+
+    for (unsigned long long latency : latencies) {
+        highest = std::max(highest, ++bins[latency / binCycles]);
+    }
+
+    printf("\n%s :\n", title);
+
+    for (unsigned int bin = 0; bin < HISTOGRAM_BINS; bin++) {
+        unsigned long width = (bins[bin] * HISTOGRAM_BAR_WIDTH + highest - 1) / highest;
+
+        printf("%10.1f us | %-*s %lu\n",
+            simulator->cyclesToUs(bin * binCycles),
+            HISTOGRAM_BAR_WIDTH,
+            std::string(width, '#').c_str(),
+            bins[bin]
+        );
+    }
+}
+
+void fillMetrics(
+    unsigned long long metrics[METRICS_COUNT],
+    const Percentiles& fromLastPulse,
+    const Percentiles& fromRelease,
+    unsigned long long speedDialCycles
+)
+{
+    metrics[0] = fromLastPulse.p50;
+    metrics[1] = fromLastPulse.p99;
+    metrics[2] = fromLastPulse.max;
+    metrics[3] = fromRelease.p50;
+    metrics[4] = fromRelease.p99;
+    metrics[5] = fromRelease.max;
+    metrics[6] = speedDialCycles;
+}
+
+static const char* const metricsNames[METRICS_COUNT] = {
+    "last_pulse.p50",
+    "last_pulse.p99",
+    "last_pulse.max",
+    "release.p50",
+    "release.p99",
+    "release.max",
+    "speed_dial.total"
+};
+
+void writeBaseline(const unsigned long long metrics[METRICS_COUNT])
+{
+    FILE* file = fopen(baselinePath, "w");
+
+    if (nullptr == file) {
+        fprintf(stderr, "Unable to write the baseline file \"%s\".\n", baselinePath);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(file, "# %s baseline. Latencies are in µC cycles at %lu Hz.\n", PROGRAM_NAME, (unsigned long) XTAL);
+    fprintf(file, "trials %lu\n", trials);
+    fprintf(file, "seed %lu\n", seed);
+
+    for (unsigned int i = 0; i < METRICS_COUNT; i++) {
+        fprintf(file, "%s %llu\n", metricsNames[i], metrics[i]);
+    }
+
+    fclose(file);
+
+    printf("\nBaseline written to %s.\n", baselinePath);
+}
+
+/**
+ * @return bool Whether the measured latencies are all within the baseline.
+ */
+bool compareBaseline(
+    Simulator* simulator,
+    const unsigned long long metrics[METRICS_COUNT]
+)
+{
+    FILE* file = fopen(baselinePath, "r");
+    char line[256], key[64];
+    unsigned long long value;
+    unsigned long long reference[METRICS_COUNT];
+    bool found[METRICS_COUNT] = { false };
+    bool ok = true;
+
+    if (nullptr == file) {
+        fprintf(stderr, "Unable to read the baseline file \"%s\".\n", baselinePath);
+        exit(EXIT_FAILURE);
+    }
+
+    while (nullptr != fgets(line, sizeof(line), file)) {
+        if ('#' == line[0] || 2 != sscanf(line, "%63s %llu", key, &value)) {
+            continue;
+        }
+
+        if ((0 == strcmp(key, "trials") && value != trials)
+            || (0 == strcmp(key, "seed") && value != seed)
+        ) {
+            fprintf(stderr, "\
+The baseline was recorded with another %s (%llu), results are not comparable.\n\
+", key, value);
+            exit(EXIT_FAILURE);
+        }
+
+        for (unsigned int i = 0; i < METRICS_COUNT; i++) {
+            if (0 == strcmp(key, metricsNames[i])) {
+                reference[i] = value;
+                found[i] = true;
+            }
+        }
+    }
+
+    fclose(file);
+
+    printf("\nBaseline %s :\n", baselinePath);
+
+    for (unsigned int i = 0; i < METRICS_COUNT; i++) {
+        if (!found[i]) {
+            printf("    %-16s missing from the baseline\n", metricsNames[i]);
+            ok = false;
+
+            continue;
+        }
+
+        const char* verdict = "ok";
+
+        if (metrics[i] > reference[i]) {
+            verdict = "REGRESSION";
+            ok = false;
+        } else if (metrics[i] < reference[i]) {
+            verdict = "improved, consider updating the baseline";
+        }
+
+        printf("    %-16s %10.1f us (baseline %10.1f us) %s\n",
+            metricsNames[i],
+            simulator->cyclesToUs(metrics[i]),
+            simulator->cyclesToUs(reference[i]),
+            verdict
+        );
+    }
+
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int optc;
+
+    trials = DEFAULT_TRIALS;
+    seed = DEFAULT_SEED;
+
+    while ((optc = getopt_long(argc, argv, "n:s:b:uhv", longopts, NULL)) != -1) {
+        switch (optc) {
+            case 'n':
+                trials = strtoul(optarg, NULL, 10);
+                break;
+
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+
+            case 'b':
+                baselinePath = optarg;
+                break;
+
+            case 'u':
+                updateBaseline = true;
+                break;
+
+            case 'h':
+                usage(EXIT_SUCCESS);
+                break;
+
+            case 'v':
+                printf("%s version %s\n", PROGRAM_NAME, PROGRAM_VERSION);
+                exit(EXIT_SUCCESS);
+                break;
+
+            default:
+                usage(EXIT_FAILURE);
+        }
+    }
+
+    if (0 == trials || 0 == seed || (updateBaseline && nullptr == baselinePath)) {
+        usage(EXIT_FAILURE);
+    }
+
+    Simulator* simulator = Simulator::build(XTAL);
+    RotaryDial rotaryDial(simulator, ROTARY_MOVE_PIN, PULSE_PIN);
+
+    DialedDigit* dialedDigit = new DialedDigit();
+    RotaryListener* rotaryListener = RotaryListener::build(dialedDigit, PIN_POLL_DELAY_MS);
+    DtmfGenerator* dtmfGenerator = DtmfGenerator::build(dialedDigit, DTMF_DURATION_MS);
+
+    rotaryListener->setup();
+    dtmfGenerator->setup();
+
+    ToneProbe probe = { 0, 0, 0, 0 };
+    simulator->onSample(probeTone, &probe);
+
+    unsigned long long randomState = seed;
+    unsigned long missed = 0, early = 0;
+    std::vector<unsigned long long> fromLastPulse, fromRelease;
+
+    for (unsigned long i = 0; i < trials; i++) {
+        // randomize the phase of the dialing against the pins polling
+        unsigned long long startCycle = simulator->now()
+            + simulator->msToCycles(DIALINGS_GAP_MS)
+            + randomBetween(&randomState, 0, simulator->msToCycles(PIN_POLL_DELAY_MS) - 1)
+        ;
+
+        DialTimeline timeline = rotaryDial.dial(
+            startCycle,
+            randomBetween(&randomState, 0, 9),
+            randomBetween(&randomState, WIND_UP_MIN_MS, WIND_UP_MAX_MS),
+            randomBetween(&randomState, RELEASE_DELAY_MIN_MS, RELEASE_DELAY_MAX_MS)
+        );
+
+        probe.trialStartCycle = timeline.offNormalCycle;
+        probe.firstToneCycle = 0;
+
+        simulator->runUntil(timeline.releaseCycle + simulator->msToCycles(TONE_TIMEOUT_MS));
+
+        if (0 == probe.firstToneCycle) {
+            ++missed;
+        } else if (probe.firstToneCycle < timeline.releaseCycle) {
+            ++early;
+        } else {
+            fromLastPulse.push_back(probe.firstToneCycle - timeline.lastPulseEndCycle);
+            fromRelease.push_back(probe.firstToneCycle - timeline.releaseCycle);
+        }
+    }
+
+    // store the number in the slot layout of the firmware, and play it with the
+    // shortest hold the polls can tell
+    const unsigned int slotAddress = SPEED_DIAL_EEPROM_ADDRESS + SPEED_DIAL_SLOT * SPEED_DIAL_SLOT_SIZE;
+    const unsigned int speedDialDigitsCount = strlen(SPEED_DIAL_NUMBER);
+
+    EEPROM.update(slotAddress, speedDialDigitsCount);
+
+    for (unsigned int i = 0; i < speedDialDigitsCount; i++) {
+        EEPROM.update(slotAddress + 1 + i, SPEED_DIAL_NUMBER[i] - '0');
+    }
+
+    DialTimeline speedDialTimeline = rotaryDial.dial(
+        simulator->now() + simulator->msToCycles(DIALINGS_GAP_MS),
+        SPEED_DIAL_SLOT,
+        SPEED_DIAL_HOLD_MS + PIN_POLL_DELAY_MS,
+        RELEASE_DELAY_MAX_MS
+    );
+
+    probe.trialStartCycle = speedDialTimeline.offNormalCycle;
+    probe.firstToneCycle = 0;
+    simulator->runUntil(speedDialTimeline.releaseCycle + simulator->msToCycles(SPEED_DIAL_TIMEOUT_MS));
+
+    const unsigned long long speedDialCycles = probe.lastToneCycle - speedDialTimeline.offNormalCycle;
+
+    printf("%s : %lu trials, seed %lu, XTAL %lu Hz, poll delay %d ms (%.1f µs actual, %s)\n",
+        PROGRAM_NAME, trials, seed, (unsigned long) XTAL, PIN_POLL_DELAY_MS,
+        RotaryListener::getPollPeriodUs(PIN_POLL_DELAY_MS),
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
+        "polled on the DTMF PWM timer"
+#else
+        "polled on TCB2"
+#endif
+    );
+
+    if (0 == probe.firstToneCycle || probe.firstToneCycle < speedDialTimeline.releaseCycle) {
+        ++missed;
+    }
+
+    if (missed > 0 || early > 0) {
+        printf("\n%lu digits without tone, %lu tones before the rotary release.\n", missed, early);
+
+        return EXIT_FAILURE;
+    }
+
+    Percentiles lastPulsePercentiles = computePercentiles(fromLastPulse);
+    Percentiles releasePercentiles = computePercentiles(fromRelease);
+
+    printf("\n%-20s %12s %12s %12s\n", "latency", "p50 (us)", "p99 (us)", "max (us)");
+    printf("%-20s %12.1f %12.1f %12.1f\n",
+        "from last pulse",
+        simulator->cyclesToUs(lastPulsePercentiles.p50),
+        simulator->cyclesToUs(lastPulsePercentiles.p99),
+        simulator->cyclesToUs(lastPulsePercentiles.max)
+    );
+    printf("%-20s %12.1f %12.1f %12.1f\n",
+        "from release",
+        simulator->cyclesToUs(releasePercentiles.p50),
+        simulator->cyclesToUs(releasePercentiles.p99),
+        simulator->cyclesToUs(releasePercentiles.max)
+    );
+
+    printf("\nspeed dial of %u digits : %.1f ms from the rotary leaving rest to the last tone end (%.1f ms from the release)\n",
+        speedDialDigitsCount,
+        simulator->cyclesToUs(speedDialCycles) / 1000,
+        simulator->cyclesToUs(probe.lastToneCycle - speedDialTimeline.releaseCycle) / 1000
+    );
+
+    printHistogram(simulator, "from last pulse", fromLastPulse);
+    printHistogram(simulator, "from release", fromRelease);
+
+    if (nullptr == baselinePath) {
+        return EXIT_SUCCESS;
+    }
+
+    unsigned long long metrics[METRICS_COUNT];
+    fillMetrics(metrics, lastPulsePercentiles, releasePercentiles, speedDialCycles);
+
+    if (updateBaseline) {
+        writeBaseline(metrics);
+
+        return EXIT_SUCCESS;
+    }
+
+    return compareBaseline(simulator, metrics) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,254 @@
+/**
+ * Streams in real time the DTMF output of the firmware, running on a virtual
+ * clock, as PCM audio : the duty cycles of the output PWM are low pass
+ * filtered and resampled, as the filter of the board would do, so that they
+ * can be fed to software DTMF decoders (e.g. multimon-ng) without any analog
+ * capture.
+ *
+ * The rotary is driven by dial scripts (see DialScript.h), read from a file,
+ * stdin, or a UNIX socket. Each tone is reported with its latency from the
+ * rotary release, and the stream with its buffering latency.
+ *
+ * The firmware is built with ENABLE_DIALED_DIGIT_HOOK, the tones being
+ * expected from the digits it queues.
+ *
+ * $ make stream
+ * $ build/host/dtmf_pcm_stream --help
+ */
+
+#include "Variables.h"
+#include "DialedDigit.h"
+#include "RotaryListener.h"
+#include "DtmfGenerator.h"
+#include "Simulator.h"
+#include "PcmOutput.h"
+#include "ScriptInput.h"
+#include "Streamer.h"
+
+#include <Arduino.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#define PROGRAM_NAME "dtmf_pcm_stream"
+#define PROGRAM_VERSION "0.1.0"
+
+// multimon-ng expects raw audio at 22050Hz
+#define DEFAULT_RATE 22050
+// the telephone band upper limit
+#define DEFAULT_CUTOFF 3400
+#define DEFAULT_BUFFER_MS 100
+#define DEFAULT_REPORT_MS 1000
+
+static const char* outputTarget = "-";
+static const char* inputTarget = "-";
+static unsigned long rate, cutoff, bufferMs, reportMs, loops = 1;
+static bool verbose = false;
+static volatile sig_atomic_t stopping = 0;
+
+static struct option const longopts[] =
+{
+    {"output", required_argument, NULL, 'o'},
+    {"input", required_argument, NULL, 'i'},
+    {"loop", required_argument, NULL, 'l'},
+    {"rate", required_argument, NULL, 'r'},
+    {"cutoff", required_argument, NULL, 'c'},
+    {"buffer", required_argument, NULL, 'B'},
+    {"report", required_argument, NULL, 'R'},
+    {"verbose", no_argument, NULL, 'V'},
+    {"help", no_argument, NULL, 'h'},
+    {"version", no_argument, NULL, 'v'},
+    {NULL, 0, NULL, 0}
+};
+
+void usage(int status)
+{
+    if (status != EXIT_SUCCESS) {
+        fprintf(stderr, "Try '%s --help' for more information.\n", PROGRAM_NAME);
+    } else {
+        printf("\
+Usage: %s [OPTION]...\n\
+", PROGRAM_NAME);
+        printf("\
+\n\
+Runs the firmware on a virtual clock paced on the wall clock, dials the\n\
+scripted digits on a simulated S63 rotary, and streams the DTMF output as\n\
+mono signed 16bit PCM (host endianness). The tones and the stream latencies\n\
+are reported on stderr.\n\
+");
+
+        printf("\
+\n\
+Stream options :\n\
+    -o, --output TARGET    Where to stream : '-' for stdout, 'pty' for a new\n\
+                           pseudo terminal, or 'unix:PATH' to listen on a UNIX\n\
+                           socket (the stream starts with the first client).\n\
+                           Defaults to '-'.\n\
+    -r, --rate             The PCM sample rate, in Hz. Defaults to %d.\n\
+    -c, --cutoff           The low pass filter cutoff, in Hz. Defaults to %d.\n\
+    -B, --buffer           The max amount of audio held for a slow consumer,\n\
+                           in ms, the oldest samples being dropped beyond.\n\
+                           Defaults to %d.\n\
+", DEFAULT_RATE, DEFAULT_CUTOFF, DEFAULT_BUFFER_MS);
+        printf("\
+\n\
+Script options :\n\
+    -i, --input SOURCE     The dial script : '-' for stdin, a file, or\n\
+                           'unix:PATH' to listen on a UNIX socket for scripts\n\
+                           lines. Defaults to '-'.\n\
+    -l, --loop             How many times a script file is played, 0 being\n\
+                           forever. A looped script must have a dial or a\n\
+                           wait command. Defaults to 1.\n\
+\n\
+The script holds one command per line :\n\
+    dial 0123              Dial the digits.\n\
+    wait 500               Do not dial for 500ms.\n\
+    windup|release|gap 50  Change the dialing timings (in ms, see DialScript.h).\n\
+");
+        printf("\
+\n\
+Printing options :\n\
+    -R, --report           How often the stream latency is reported, in ms,\n\
+                           0 to disable. Defaults to %d.\n\
+    -V, --verbose          Also print the firmware logs.\n\
+", DEFAULT_REPORT_MS);
+
+        printf("\
+\n\
+Common options :\n\
+    --help                 Display this help and exit.\n\
+    --version              Output version information and exit.\n\
+\n\
+Examples :\n\
+    $ echo 'dial 0123456789' | %s | multimon-ng -t raw -a DTMF -\n\
+    $ %s -o unix:/tmp/s63.pcm -i unix:/tmp/s63.dial\n\
+    $ socat -u UNIX-CONNECT:/tmp/s63.pcm - | multimon-ng -t raw -a DTMF -\n\
+    $ echo 'dial 42' | socat -u - UNIX-CONNECT:/tmp/s63.dial\n\
+\n\
+", PROGRAM_NAME, PROGRAM_NAME);
+    }
+
+    exit(status);
+}
+
+unsigned long parseNumber(const char* value)
+{
+    char* end;
+    unsigned long number = strtoul(value, &end, 10);
+
+    if ('\0' == value[0] || '\0' != *end || '-' == value[0]) {
+        fprintf(stderr, "Invalid number \"%s\".\n", value);
+        usage(EXIT_FAILURE);
+    }
+
+    return number;
+}
+
+void stop(int /* signal */)
+{
+    stopping = 1;
+}
+
+int main(int argc, char** argv)
+{
+    int optc;
+
+    rate = DEFAULT_RATE;
+    cutoff = DEFAULT_CUTOFF;
+    bufferMs = DEFAULT_BUFFER_MS;
+    reportMs = DEFAULT_REPORT_MS;
+
+    while ((optc = getopt_long(argc, argv, "o:i:l:r:c:B:R:Vhv", longopts, NULL)) != -1) {
+        switch (optc) {
+            case 'o':
+                outputTarget = optarg;
+                break;
+
+            case 'i':
+                inputTarget = optarg;
+                break;
+
+            case 'l':
+                loops = parseNumber(optarg);
+                break;
+
+            case 'r':
+                rate = parseNumber(optarg);
+                break;
+
+            case 'c':
+                cutoff = parseNumber(optarg);
+                break;
+
+            case 'B':
+                bufferMs = parseNumber(optarg);
+                break;
+
+            case 'R':
+                reportMs = parseNumber(optarg);
+                break;
+
+            case 'V':
+                verbose = true;
+                break;
+
+            case 'h':
+                usage(EXIT_SUCCESS);
+                break;
+
+            case 'v':
+                printf("%s version %s\n", PROGRAM_NAME, PROGRAM_VERSION);
+                exit(EXIT_SUCCESS);
+                break;
+
+            default:
+                usage(EXIT_FAILURE);
+        }
+    }
+
+    if (optind != argc || 0 == rate || 0 == bufferMs || 2 * cutoff >= rate) {
+        usage(EXIT_FAILURE);
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (verbose) {
+        Serial.begin(9600);
+    }
+
+    Simulator* simulator = Simulator::build(XTAL);
+
+    DialedDigit* dialedDigit = new DialedDigit();
+    RotaryListener* rotaryListener = RotaryListener::build(dialedDigit, PIN_POLL_DELAY_MS);
+    DtmfGenerator* dtmfGenerator = DtmfGenerator::build(dialedDigit, DTMF_DURATION_MS);
+
+    ScriptInput input;
+    PcmOutput output;
+    std::string error;
+
+    if (!input.open(inputTarget, loops, &error) || !output.open(outputTarget, &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        usage(EXIT_FAILURE);
+    }
+
+    if (output.isListening()) {
+        fprintf(stderr, "Waiting for a client on %s ...\n", outputTarget + 5);
+
+        while (!stopping && !output.acceptClient(100)) {}
+    }
+
+    Streamer streamer(simulator, dialedDigit, &output, &input, rate, cutoff, bufferMs, reportMs);
+
+    rotaryListener->setup();
+    dtmfGenerator->setup();
+
+    fprintf(stderr, "%s : %lu Hz PCM, low pass at %lu Hz, %lu ms buffer, from %lu Hz samples\n",
+        PROGRAM_NAME, rate, cutoff, bufferMs, (unsigned long) DtmfGenerator::PERIOD_FREQUENCY
+    );
+
+    return streamer.run(&stopping) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,66 @@
+#ifndef S63_HOST_ARDUINO_H
+#define S63_HOST_ARDUINO_H
+
+/**
+ * Host replacement of the Arduino core header, providing only what the
+ * firmware uses.
+ *
+ * The pins are read from the Simulator, and the Serial output is discarded
+ * unless `Serial.begin()` has been called (i.e. when the firmware is built
+ * with ENABLE_LOGGING or ENABLE_PIN_CAPTURE), in which case it is written to
+ * stderr, or to the file given to `Serial.setOutput()`.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+
+class String
+{
+    public:
+        String(const char* value);
+        String(const std::string& value);
+
+        const char* c_str() const;
+
+        String operator+(const char* value) const;
+        String operator+(int value) const;
+        String operator+(unsigned int value) const;
+        String operator+(long value) const;
+        String operator+(unsigned long value) const;
+
+    private:
+        std::string value;
+};
+
+class HardwareSerial
+{
+    public:
+        HardwareSerial();
+
+        void begin(unsigned long baudRate);
+        void setOutput(FILE* output);
+        size_t write(uint8_t value);
+        size_t write(const char* value);
+        void println(const char* value);
+        void println(const String& value);
+
+    private:
+        bool enabled;
+        FILE* output;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef S63_HOST_EEPROM_H
+#define S63_HOST_EEPROM_H
+
+/**
+ * Host replacement of the Arduino EEPROM library, providing only what the
+ * firmware uses. The EEPROM is kept in memory, and starts erased (all bytes
+ * reading 0xFF) as on a new chip.
+ */
+
+#include <avr/io.h>
+#include <stdint.h>
+
+class EEPROMClass
+{
+    public:
+        EEPROMClass();
+
+        uint8_t read(int index) const;
+        void update(int index, uint8_t value);
+        uint16_t length() const;
+
+    private:
+        uint8_t bytes[EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef S63_HOST_AVR_INTERRUPT_H
+#define S63_HOST_AVR_INTERRUPT_H
+
+/**
+ * Host replacement of the avr-libc <avr/interrupt.h> header.
+ *
+ * An ISR becomes a plain function named after its vector, which the Simulator
+ * calls when the corresponding timer fires. The vectors are weak symbols, as
+ * the firmware only defines the ISRs of the timers it uses.
+ */
+
+#define ISR(vector) extern "C" void vector(void)
+
+extern "C" void TCA0_OVF_vect(void) __attribute__((weak));
+extern "C" void TCB1_INT_vect(void) __attribute__((weak));
+extern "C" void TCB2_INT_vect(void) __attribute__((weak));
+
+#define sei()
+#define cli()
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef S63_HOST_AVR_IO_H
+#define S63_HOST_AVR_IO_H
+
+/**
+ * Host replacement of the avr-libc <avr/io.h> header.
+ *
+ * Only the ATmega4809 registers and bitmasks used by the firmware are modelled.
+ * The bitmask values are copied from avr/include/avr/iom4809.h, so that the
+ * firmware configures the peripherals the same way it does on the chip. The
+ * registers are plain memory which the Simulator reads to know when and how
+ * often it should trigger the ISRs.
+ */
+
+#include <stdint.h>
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+
+typedef struct TCB_struct
+{
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t EVCTRL;
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t STATUS;
+    register8_t DBGCTRL;
+    register8_t TEMP;
+    // CNT and CCMP are 16bit registries, which can also be accessed byte by
+    // byte (the L suffix being the low byte).
+    union {
+        register16_t CNT;
+        struct {
+            register8_t CNTL;
+            register8_t CNTH;
+        };
+    };
+    // in 8bit PWM mode, CCMPL is the period and CCMPH the duty cycle
+    union {
+        register16_t CCMP;
+        struct {
+            register8_t CCMPL;
+            register8_t CCMPH;
+        };
+    };
+} TCB_t;
+
+typedef struct TCA_SINGLE_struct
+{
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t CTRLC;
+    register8_t CTRLD;
+    register8_t CTRLECLR;
+    register8_t CTRLESET;
+    register8_t CTRLFCLR;
+    register8_t CTRLFSET;
+    register8_t EVCTRL;
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t DBGCTRL;
+    register8_t TEMP;
+    register16_t CNT;
+    register16_t PER;
+    register16_t CMP0;
+    register16_t CMP1;
+    register16_t CMP2;
+    register16_t PERBUF;
+    register16_t CMP0BUF;
+    register16_t CMP1BUF;
+    register16_t CMP2BUF;
+} TCA_SINGLE_t;
+
+typedef union TCA_union
+{
+    TCA_SINGLE_t SINGLE;
+} TCA_t;
+
+typedef struct PORT_struct
+{
+    register8_t DIR;
+    register8_t DIRSET;
+    register8_t DIRCLR;
+    register8_t DIRTGL;
+    register8_t OUT;
+    register8_t OUTSET;
+    register8_t OUTCLR;
+    register8_t OUTTGL;
+    register8_t IN;
+} PORT_t;
+
+typedef struct PORTMUX_struct
+{
+    register8_t EVSYSROUTEA;
+    register8_t CCLROUTEA;
+    register8_t USARTROUTEA;
+    register8_t TWISPIROUTEA;
+    register8_t TCAROUTEA;
+    register8_t TCBROUTEA;
+} PORTMUX_t;
+
+extern PORTMUX_t PORTMUX;
+extern PORT_t PORTB;
+extern TCA_t TCA0;
+extern TCB_t TCB0;
+extern TCB_t TCB1;
+extern TCB_t TCB2;
+
+#define EEPROM_SIZE (256U)
+
+#define PIN0_bm 0x01
+
+#define PORTMUX_TCA0_PORTB_gc (0x01<<0)
+#define PORTMUX_TCB1_bm 0x02
+
+#define TCA_SINGLE_ENABLE_bm 0x01
+#define TCA_SINGLE_CLKSEL_gm 0x0E
+#define TCA_SINGLE_CLKSEL_DIV1_gc (0x00<<1)
+#define TCA_SINGLE_CLKSEL_DIV2_gc (0x01<<1)
+#define TCA_SINGLE_CLKSEL_DIV4_gc (0x02<<1)
+#define TCA_SINGLE_CLKSEL_DIV8_gc (0x03<<1)
+#define TCA_SINGLE_CLKSEL_DIV16_gc (0x04<<1)
+#define TCA_SINGLE_CLKSEL_DIV64_gc (0x05<<1)
+#define TCA_SINGLE_CLKSEL_DIV256_gc (0x06<<1)
+#define TCA_SINGLE_CLKSEL_DIV1024_gc (0x07<<1)
+
+#define TCA_SINGLE_WGMODE_gm 0x07
+#define TCA_SINGLE_WGMODE_SINGLESLOPE_gc (0x03<<0)
+#define TCA_SINGLE_CMP0EN_bm 0x10
+
+#define TCA_SINGLE_SPLITM_bm 0x01
+
+#define TCA_SINGLE_CMD_gm 0x0C
+#define TCA_SINGLE_CMD_RESET_gc (0x03<<2)
+
+#define TCA_SINGLE_OVF_bm 0x01
+
+#define TCB_ENABLE_bm 0x01
+#define TCB_CLKSEL_gm 0x06
+#define TCB_CLKSEL_CLKDIV1_gc (0x00<<1)
+#define TCB_CLKSEL_CLKDIV2_gc (0x01<<1)
+#define TCB_CLKSEL_CLKTCA_gc (0x02<<1)
+
+#define TCB_CNTMODE_gm 0x07
+#define TCB_CNTMODE_INT_gc (0x00<<0)
+#define TCB_CNTMODE_PWM8_gc (0x07<<0)
+#define TCB_CCMPEN_bm 0x10
+
+#define TCB_CAPTEI_bm 0x01
+#define TCB_CAPT_bm 0x01
+
+#endif
@@ -0,0 +1,475 @@
+/**
+ * Replays the pins captures exported by the firmware built with
+ * ENABLE_PIN_CAPTURE through the rotary decoder, on a virtual clock.
+ *
+ * The input is the raw serial output of the board, in which the capture frames
+ * are looked for (the logs may be interleaved with them). Each captured poll
+ * is replayed to the decoder, which is itself built with the capture enabled :
+ * the replay is bit exact when the decoder freezes for the same reason and
+ * records the very same entries.
+ *
+ * $ make replay CAPTURE=<file>
+ * $ build/host/pin_capture_replay --help
+ */
+
+#include "Variables.h"
+#include "DialedDigit.h"
+#include "PinCapture.h"
+#include "RotaryListener.h"
+#include "DtmfGenerator.h"
+#include "Simulator.h"
+
+#include <Arduino.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define PROGRAM_NAME "pin_capture_replay"
+#define PROGRAM_VERSION "0.1.0"
+
+// the frame bytes around the entries (i.e. without the magic)
+#define FRAME_HEADER_SIZE 10
+#define FRAME_CHECKSUM_SIZE 2
+// how many polls with the rotary at rest are replayed before a capture, in
+// order to start from a known decoder state
+#define REST_POLLS_COUNT 4
+
+static bool verbose = false;
+// how many anomalies the capture holds, 0 when unknown
+static unsigned long expectedCount = 0;
+
+static struct option const longopts[] =
+{
+    {"expect", required_argument, NULL, 'e'},
+    {"verbose", no_argument, NULL, 'V'},
+    {"help", no_argument, NULL, 'h'},
+    {"version", no_argument, NULL, 'v'},
+    {NULL, 0, NULL, 0}
+};
+
+struct CaptureFrame
+{
+    unsigned char reason;
+    unsigned int pollPeriodUs;
+    unsigned long firstPoll;
+    std::vector<unsigned int> entries;
+};
+
+void usage(int status)
+{
+    if (status != EXIT_SUCCESS) {
+        fprintf(stderr, "Try '%s --help' for more information.\n", PROGRAM_NAME);
+    } else {
+        printf("\
+Usage: %s [OPTION]... FILE\n\
+", PROGRAM_NAME);
+        printf("\
+\n\
+Looks for the pins capture frames in FILE (the raw serial output of the board)\n\
+and replays them through the rotary decoder. Prints the decoded digits, and\n\
+exits with a failure status when any anomaly is not reproduced bit for bit.\n\
+");
+
+        printf("\
+\n\
+Replay options :\n\
+    -e, --expect COUNT     How many anomalies FILE holds, the replay failing\n\
+                           when another count is found (e.g. for a fixture).\n\
+");
+
+        printf("\
+\n\
+Printing options :\n\
+    -V, --verbose          Also print the pins levels changes.\n\
+");
+
+        printf("\
+\n\
+Common options :\n\
+    --help                 Display this help and exit.\n\
+    --version              Output version information and exit.\n\
+\n\
+");
+    }
+
+    exit(status);
+}
+
+unsigned long parseNumber(const char* value)
+{
+    char* end;
+    unsigned long number = strtoul(value, &end, 10);
+
+    if ('\0' == value[0] || '\0' != *end || '-' == value[0]) {
+        fprintf(stderr, "Invalid number \"%s\".\n", value);
+        usage(EXIT_FAILURE);
+    }
+
+    return number;
+}
+
+unsigned int readWord(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+unsigned long readLong(const unsigned char* bytes)
+{
+    return readWord(bytes) | ((unsigned long) readWord(bytes + 2) << 16);
+}
+
+/**
+ * @return size_t The size of the frame starting at `bytes` (magic excluded),
+ * or 0 when there is no valid frame there.
+ */
+size_t parseFrame(const unsigned char* bytes, size_t size, CaptureFrame* frame)
+{
+    if (size < FRAME_HEADER_SIZE + FRAME_CHECKSUM_SIZE
+        || PIN_CAPTURE_FORMAT_VERSION != bytes[0]
+    ) {
+        return 0;
+    }
+
+    unsigned int entriesCount = readWord(bytes + 8);
+    size_t frameSize = FRAME_HEADER_SIZE + 2 * entriesCount + FRAME_CHECKSUM_SIZE;
+
+    if (entriesCount > PIN_CAPTURE_ENTRIES_COUNT || size < frameSize) {
+        return 0;
+    }
+
+    unsigned int checksum = 0;
+
+    for (size_t i = 0; i < frameSize - FRAME_CHECKSUM_SIZE; i++) {
+        checksum += bytes[i];
+    }
+
+    if ((checksum & 0xFFFF) != readWord(bytes + frameSize - FRAME_CHECKSUM_SIZE)) {
+        return 0;
+    }
+
+    frame->reason = bytes[1];
+    frame->pollPeriodUs = readWord(bytes + 2);
+    frame->firstPoll = readLong(bytes + 4);
+    frame->entries.clear();
+
+    for (unsigned int i = 0; i < entriesCount; i++) {
+        frame->entries.push_back(readWord(bytes + FRAME_HEADER_SIZE + 2 * i));
+    }
+
+    return frameSize;
+}
+
+std::vector<CaptureFrame> readFrames(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    std::vector<unsigned char> bytes;
+    std::vector<CaptureFrame> frames;
+    unsigned char buffer[4096];
+    size_t read;
+
+    if (nullptr == file) {
+        fprintf(stderr, "Unable to read the capture file \"%s\".\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + read);
+    }
+
+    fclose(file);
+
+    const size_t magicSize = strlen(PIN_CAPTURE_MAGIC);
+    size_t i = 0;
+
+    while (i + magicSize <= bytes.size()) {
+        if (0 != memcmp(&bytes[i], PIN_CAPTURE_MAGIC, magicSize)) {
+            ++i;
+
+            continue;
+        }
+
+        CaptureFrame frame;
+        size_t frameSize = parseFrame(&bytes[i + magicSize], bytes.size() - i - magicSize, &frame);
+
+        if (0 == frameSize) {
+            fprintf(stderr, "Skipping an invalid frame at offset %zu.\n", i);
+            ++i;
+
+            continue;
+        }
+
+        frames.push_back(frame);
+        i += magicSize + frameSize;
+    }
+
+    return frames;
+}
+
+const char* describeReason(unsigned char reason)
+{
+    switch (reason) {
+        case PIN_CAPTURE_PULSES_OVERFLOW:
+            return "pulses overflow";
+
+        case PIN_CAPTURE_ZERO_PULSE_RELEASE:
+            return "rotary released without pulse";
+
+        default:
+            return "unknown reason";
+    }
+}
+
+/**
+ * Export the decoder's own capture, which also restarts it.
+ */
+CaptureFrame exportCapture(PinCapture* pinCapture)
+{
+    char* bytes = nullptr;
+    size_t size = 0;
+    FILE* stream = open_memstream(&bytes, &size);
+    CaptureFrame frame = { 0, 0, 0, {} };
+
+    Serial.setOutput(stream);
+    pinCapture->exportIfFrozen();
+    fclose(stream);
+
+    if (size > 0) {
+        const size_t magicSize = strlen(PIN_CAPTURE_MAGIC);
+        parseFrame((const unsigned char*) bytes + magicSize, size - magicSize, &frame);
+    }
+
+    free(bytes);
+
+    return frame;
+}
+
+class Replayer
+{
+    public:
+        Replayer(
+            Simulator* simulator,
+            DialedDigit* dialedDigit,
+            RotaryListener* rotaryListener,
+            FILE* discardedOutput
+        );
+
+        bool replay(unsigned int index, const CaptureFrame& frame);
+
+    private:
+        Simulator* simulator;
+        DialedDigit* dialedDigit;
+        RotaryListener* rotaryListener;
+        FILE* discardedOutput;
+        unsigned long long lastPollCycle;
+        double pollPeriodUs;
+
+        void poll(unsigned char rotaryMovePinStatus, unsigned char pulsePinStatus);
+};
+
+Replayer::Replayer(
+    Simulator* simulator,
+    DialedDigit* dialedDigit,
+    RotaryListener* rotaryListener,
+    FILE* discardedOutput
+):  simulator(simulator),
+    dialedDigit(dialedDigit),
+    rotaryListener(rotaryListener),
+    discardedOutput(discardedOutput),
+    lastPollCycle(0),
+    pollPeriodUs(0)
+{}
+
+/**
+ * Run until the next poll of the decoder, the pins being at the given levels.
+ */
+void Replayer::poll(unsigned char rotaryMovePinStatus, unsigned char pulsePinStatus)
+{
+    PinCapture* pinCapture = this->rotaryListener->getPinCapture();
+    unsigned long pollsCount = pinCapture->getPollsCount();
+
+    this->simulator->setPin(ROTARY_MOVE_PIN, rotaryMovePinStatus);
+    this->simulator->setPin(PULSE_PIN, pulsePinStatus);
+
+    while (pollsCount == pinCapture->getPollsCount()) {
+        this->simulator->step();
+    }
+
+    this->pollPeriodUs = this->simulator->cyclesToUs(this->simulator->now() - this->lastPollCycle);
+    this->lastPollCycle = this->simulator->now();
+}
+
+/**
+ * @return bool Whether the capture anomaly has been reproduced bit for bit.
+ */
+bool Replayer::replay(unsigned int index, const CaptureFrame& frame)
+{
+    PinCapture* pinCapture = this->rotaryListener->getPinCapture();
+    const double pollMs = frame.pollPeriodUs / 1000.0;
+    unsigned long pollIndex = frame.firstPoll;
+
+    printf("frame %u : frozen on %s, %zu entries from poll %lu (%.1f ms)\n",
+        index,
+        describeReason(frame.reason),
+        frame.entries.size(),
+        frame.firstPoll,
+        frame.firstPoll * pollMs
+    );
+
+    if (frame.entries.empty()) {
+        printf("    nothing to replay\n");
+
+        return false;
+    }
+
+    if (0 == (frame.entries[0] & PIN_CAPTURE_ROTARY_MOVE_bm)) {
+        printf("    warning : the capture starts while the rotary is moving, its first pulse may be decoded differently\n");
+    }
+
+    Serial.setOutput(this->discardedOutput);
+
+    // start from a decoder at rest, with a capture restarted
+    for (unsigned int i = 0; i < REST_POLLS_COUNT; i++) {
+        this->poll(HIGH, LOW);
+    }
+
+    if (frame.pollPeriodUs != (unsigned int) (this->pollPeriodUs + 0.5)) {
+        printf("    warning : captured with a %u us poll period, the decoder polls every %.1f us\n",
+            frame.pollPeriodUs,
+            this->pollPeriodUs
+        );
+    }
+
+    pinCapture->freeze(0);
+    exportCapture(pinCapture);
+    Serial.setOutput(this->discardedOutput);
+
+    for (unsigned int entry : frame.entries) {
+        unsigned char rotaryMovePinStatus = (entry & PIN_CAPTURE_ROTARY_MOVE_bm) ? HIGH : LOW;
+        unsigned char pulsePinStatus = (entry & PIN_CAPTURE_PULSE_bm) ? HIGH : LOW;
+
+        if (verbose) {
+            printf("    poll %8lu (%10.1f ms) : rotary %s, pulse pin %s, for %u polls\n",
+                pollIndex,
+                pollIndex * pollMs,
+                HIGH == rotaryMovePinStatus ? "at rest" : "moving ",
+                HIGH == pulsePinStatus ? "HIGH" : "LOW ",
+                entry & PIN_CAPTURE_RUN_LENGTH_gm
+            );
+        }
+
+        for (unsigned int i = 0; i < (entry & PIN_CAPTURE_RUN_LENGTH_gm); i++) {
+            this->poll(rotaryMovePinStatus, pulsePinStatus);
+
+            if (this->dialedDigit->isNew()) {
+                printf("    poll %8lu (%10.1f ms) : dialed digit %u\n",
+                    pollIndex,
+                    pollIndex * pollMs,
+                    this->dialedDigit->flush()
+                );
+            }
+
+            ++pollIndex;
+        }
+    }
+
+    if (!pinCapture->isFrozen()) {
+        printf("    FAILURE : the anomaly has not been reproduced\n");
+
+        return false;
+    }
+
+    CaptureFrame replayed = exportCapture(pinCapture);
+
+    if (replayed.reason != frame.reason || replayed.entries != frame.entries) {
+        printf("    FAILURE : the decoder has frozen on %s, with %zu entries differing from the capture\n",
+            describeReason(replayed.reason),
+            replayed.entries.size()
+        );
+
+        return false;
+    }
+
+    printf("    anomaly reproduced bit for bit\n");
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int optc;
+
+    while ((optc = getopt_long(argc, argv, "e:Vhv", longopts, NULL)) != -1) {
+        switch (optc) {
+            case 'e':
+                expectedCount = parseNumber(optarg);
+                break;
+
+            case 'V':
+                verbose = true;
+                break;
+
+            case 'h':
+                usage(EXIT_SUCCESS);
+                break;
+
+            case 'v':
+                printf("%s version %s\n", PROGRAM_NAME, PROGRAM_VERSION);
+                exit(EXIT_SUCCESS);
+                break;
+
+            default:
+                usage(EXIT_FAILURE);
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(EXIT_FAILURE);
+    }
+
+    std::vector<CaptureFrame> frames = readFrames(argv[optind]);
+
+    if (frames.empty()) {
+        fprintf(stderr, "No capture frame found in \"%s\".\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    Simulator* simulator = Simulator::build(XTAL);
+    DialedDigit* dialedDigit = new DialedDigit();
+    RotaryListener* rotaryListener = RotaryListener::build(dialedDigit, PIN_POLL_DELAY_MS);
+
+    simulator->setPin(ROTARY_MOVE_PIN, HIGH);
+    simulator->setPin(PULSE_PIN, LOW);
+    rotaryListener->setup();
+
+#ifdef ROTARY_POLL_ON_DTMF_TIMER
+    // the pins are polled on the DTMF PWM timer ticks
+    DtmfGenerator::build(dialedDigit, DTMF_DURATION_MS)->setup();
+#endif
+
+    // the decoder logs are not part of the replay output
+    FILE* discardedOutput = fopen("/dev/null", "w");
+    Serial.begin(9600);
+
+    Replayer replayer(simulator, dialedDigit, rotaryListener, discardedOutput);
+    unsigned int reproduced = 0;
+
+    for (unsigned int i = 0; i < frames.size(); i++) {
+        if (replayer.replay(i + 1, frames[i])) {
+            ++reproduced;
+        }
+    }
+
+    fclose(discardedOutput);
+
+    printf("\n%u of %zu anomalies reproduced.\n", reproduced, frames.size());
+
+    if (0 != expectedCount && expectedCount != frames.size()) {
+        printf("FAILURE : %lu anomalies expected.\n", expectedCount);
+
+        return EXIT_FAILURE;
+    }
+
+    return reproduced == frames.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,6 +1,7 @@
 /**
  * Generates and prints the values of a sinware to use in a lookup table for
- * sinwave generation by Pulse Width Modulation.
+ * sinwave generation by Pulse Width Modulation, or of a raised cosine ramp to
+ * use in a lookup table for the attack and decay envelopes of the tones.
  *
  * $ gcc sinwave_lookup_table_generator.c -o slg -lm
  * $ ./slg --help
@@ -19,12 +20,14 @@
 #define DEFAULT_COLUMNS 8 // the amount of columns on which print the results
 
 static unsigned int samples_count, values_range, columns;
+static int ramp;
 
 static struct option const longopts[] =
 {
     {"samples-count", required_argument, NULL, 's'},
     {"values-range", required_argument, NULL, 'r'},
     {"columns", required_argument, NULL, 'c'},
+    {"ramp", no_argument, NULL, 'R'},
     {"help", no_argument, NULL, 'h'},
     {"version", no_argument, NULL, 'v'},
     {NULL, 0, NULL, 0}
@@ -56,6 +59,16 @@ should be composed of, and what should be the values range to use.\n\
 ", DEFAULT_SAMPLES_COUNT, DEFAULT_VALUES_RANGE);
         printf("\
 \n\
+Ramp mode :\n\
+    -R, --ramp             Generate a raised cosine ramp going from 0 to\n\
+                           `values-range` included instead, composed of\n\
+                           `samples-count` samples. The ramp is used as is for\n\
+                           the attack of a tone, and read backward for its\n\
+                           decay.\n\
+");
+
+        printf("\
+\n\
 Printing options :\n\
     -c, --columns          The number of columns on which print the results.\n\
                            Defaults to %d. The results are comma separated.\n\
@@ -73,7 +86,7 @@ Common options :\n\
     exit(status);
 }
 
-void compute(unsigned int table[])
+void compute_sinwave(unsigned int table[])
 {
     unsigned int i = 0;
     double sin_val;
@@ -95,6 +108,28 @@ void compute(unsigned int table[])
     }
 }
 
+void compute_ramp(unsigned int table[])
+{
+    unsigned int i = 0;
+    double gain;
+
+    for (i = 0; i < samples_count; i++)
+    {
+        // half a cosine period, from its max to its min, flipped and offset
+        // to go from 0 to 1. The ramp ends on its last sample (i.e. the last
+        // value is the full range), so that the tone is not attenuated once
+        // the attack is over.
+        gain = (1.0 - cos((i + 1) * (M_PI / samples_count))) / 2.0;
+
+        // and we scale the value to our range, on order to have [0 : RANGE]
+        // final values.
+        gain = gain * values_range;
+
+        // store as unsigned int
+        table[i] = (unsigned int) round(gain);
+    }
+}
+
 void print_on_one_line(unsigned int table[])
 {
     unsigned int i;
@@ -160,8 +195,9 @@ int main (int argc, char **argv) {
     samples_count = DEFAULT_SAMPLES_COUNT;
     values_range = DEFAULT_VALUES_RANGE;
     columns = DEFAULT_COLUMNS;
+    ramp = 0;
 
-    while ((optc = getopt_long(argc, argv, "s:r:c:hv", longopts, NULL)) != -1) {
+    while ((optc = getopt_long(argc, argv, "s:r:c:Rhv", longopts, NULL)) != -1) {
         switch (optc) {
             case 's':
                 samples_count = (unsigned int) atoi(optarg);
@@ -170,7 +206,7 @@ int main (int argc, char **argv) {
             case 'r':
                 received_values_range_opt = atoi(optarg);
 
-                if (!received_values_range_opt >= 0) {
+                if (received_values_range_opt < 0) {
                     fprintf(stderr, "\
 The values range should be greater or equal to 0, received \"%d\".\n\
 ", received_values_range_opt);
@@ -184,6 +220,10 @@ The values range should be greater or equal to 0, received \"%d\".\n\
                 columns = (unsigned int) atoi(optarg);
                 break;
 
+            case 'R':
+                ramp = 1;
+                break;
+
             case 'h':
                 usage(EXIT_SUCCESS);
                 break;
@@ -204,7 +244,12 @@ The values range should be greater or equal to 0, received \"%d\".\n\
 
     table = (unsigned int*) malloc(samples_count * sizeof(unsigned int));
 
-    compute(table);
+    if (ramp) {
+        compute_ramp(table);
+    } else {
+        compute_sinwave(table);
+    }
+
     print(table);
 
     free(table);